@@ -1,43 +1,142 @@
 #include "devices/input.h"
 #include <debug.h>
-#include "devices/intq.h"
 #include "devices/serial.h"
+#include "threads/interrupt.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
 
-/* Stores keys from the keyboard and serial port. */
-static struct intq buffer;
+/* Input buffer size, in bytes.  Must be a power of 2. */
+#define INPUT_BUFSIZE 1024
+
+/* Stores keys from the keyboard and serial port.
+
+   Positions are free-running counters reduced modulo
+   INPUT_BUFSIZE.  Keys between TAIL and LINE_END may be read.
+   In canonical mode, keys between LINE_END and HEAD are the line
+   still being typed; in raw mode LINE_END always equals HEAD. */
+static uint8_t buffer[INPUT_BUFSIZE];
+static unsigned head;           /* New keys are written here. */
+static unsigned tail;           /* Old keys are read here. */
+static unsigned line_end;       /* End of the readable keys. */
+
+static enum input_mode mode;    /* Current line discipline. */
+
+/* Readers.  Only one may wait at once. */
+static struct lock read_lock;
+static struct thread *reader;   /* Thread waiting for input. */
 
 /* Initializes the input buffer. */
 void
 input_init (void) 
 {
-  intq_init (&buffer);
+  head = tail = line_end = 0;
+  mode = INPUT_RAW;
+  lock_init (&read_lock);
+  reader = NULL;
+}
+
+/* Sets the line discipline to NEW_MODE and returns the old one.
+   Anything already typed becomes readable at once. */
+enum input_mode
+input_set_mode (enum input_mode new_mode) 
+{
+  enum intr_level old_level;
+  enum input_mode old_mode;
+
+  ASSERT (new_mode == INPUT_RAW || new_mode == INPUT_CANONICAL);
+
+  old_level = intr_disable ();
+  old_mode = mode;
+  mode = new_mode;
+  line_end = head;
+  if (reader != NULL && line_end != tail)
+    {
+      thread_unblock (reader);
+      reader = NULL;
+    }
+  intr_set_level (old_level);
+  return old_mode;
 }
 
 /* Adds a key to the input buffer.
+   In canonical mode, carriage returns become new-lines, a
+   new-line completes the current line, and backspace or delete
+   erases the last key of the current line.
    Interrupts must be off and the buffer must not be full. */
 void
 input_putc (uint8_t key) 
 {
   ASSERT (intr_get_level () == INTR_OFF);
-  ASSERT (!intq_full (&buffer));
+  ASSERT (!input_full ());
+
+  if (mode == INPUT_CANONICAL && (key == '\b' || key == 0x7f))
+    {
+      if (head != line_end)
+        head--;
+    }
+  else
+    {
+      if (mode == INPUT_CANONICAL && key == '\r')
+        key = '\n';
+      buffer[head++ % INPUT_BUFSIZE] = key;
+
+      /* A line too long for the buffer is handed over as is,
+         rather than waiting forever for its end. */
+      if (mode == INPUT_RAW || key == '\n' || input_full ())
+        line_end = head;
+    }
 
-  intq_putc (&buffer, key);
+  if (reader != NULL && line_end != tail)
+    {
+      thread_unblock (reader);
+      reader = NULL;
+    }
   serial_notify ();
 }
 
+/* Reads up to SIZE keys into DST and returns the number read.
+   Waits until at least one key is available, then takes all the
+   keys available, in one pass with interrupts off.  In canonical
+   mode, waits for a complete line and stops after its new-line,
+   so that each call returns at most one line. */
+size_t
+input_read (uint8_t *dst, size_t size) 
+{
+  enum intr_level old_level;
+  size_t cnt = 0;
+
+  if (size == 0)
+    return 0;
+
+  lock_acquire (&read_lock);
+  old_level = intr_disable ();
+  while (line_end == tail)
+    {
+      reader = thread_current ();
+      thread_block ();
+    }
+  while (cnt < size && tail != line_end)
+    {
+      uint8_t key = buffer[tail++ % INPUT_BUFSIZE];
+      dst[cnt++] = key;
+      if (mode == INPUT_CANONICAL && key == '\n')
+        break;
+    }
+  serial_notify ();
+  intr_set_level (old_level);
+  lock_release (&read_lock);
+
+  return cnt;
+}
+
 /* Retrieves a key from the input buffer.
    If the buffer is empty, waits for a key to be pressed. */
 uint8_t
 input_getc (void) 
 {
-  enum intr_level old_level;
   uint8_t key;
 
-  old_level = intr_disable ();
-  key = intq_getc (&buffer);
-  serial_notify ();
-  intr_set_level (old_level);
-  
+  input_read (&key, 1);
   return key;
 }
 
@@ -48,5 +147,5 @@ bool
 input_full (void) 
 {
   ASSERT (intr_get_level () == INTR_OFF);
-  return intq_full (&buffer);
+  return head - tail >= INPUT_BUFSIZE;
 }
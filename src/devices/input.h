@@ -2,10 +2,20 @@
 #define DEVICES_INPUT_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
+/* Line disciplines. */
+enum input_mode
+  {
+    INPUT_RAW,                  /* Keys are readable as typed. */
+    INPUT_CANONICAL             /* Keys are readable a line at a time. */
+  };
+
 void input_init (void);
+enum input_mode input_set_mode (enum input_mode);
 void input_putc (uint8_t);
+size_t input_read (uint8_t *, size_t);
 uint8_t input_getc (void);
 bool input_full (void);
 
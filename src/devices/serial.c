@@ -1,7 +1,7 @@
 #include "devices/serial.h"
 #include <debug.h>
+#include <string.h>
 #include "devices/input.h"
-#include "devices/intq.h"
 #include "devices/timer.h"
 #include "threads/io.h"
 #include "threads/interrupt.h"
@@ -44,6 +44,14 @@
 /* MODEM Control Register. */
 #define MCR_OUT2 0x08           /* Output line 2. */
 
+/* FIFO Control Register bits. */
+#define FCR_ENABLE 0x01         /* Enable the FIFOs. */
+#define FCR_CLEAR_RX 0x02       /* Clear the receive FIFO. */
+#define FCR_CLEAR_TX 0x04       /* Clear the transmit FIFO. */
+
+/* Depth of the 16550A's transmit FIFO, in bytes. */
+#define FIFO_DEPTH 16
+
 /* Line Status Register. */
 #define LSR_DR 0x01             /* Data Ready: received data byte is in RBR. */
 #define LSR_THRE 0x20           /* THR Empty. */
@@ -51,11 +59,21 @@
 /* Transmission mode. */
 static enum { UNINIT, POLL, QUEUE } mode;
 
-/* Data to be transmitted. */
-static struct intq txq;
+/* Transmit buffer size, in bytes.  Must be a power of 2. */
+#define TXQ_SIZE 4096
+
+/* Data to be transmitted.  Positions are free-running counters
+   reduced modulo TXQ_SIZE. */
+static uint8_t txq[TXQ_SIZE];
+static unsigned txq_head;       /* New data is written here. */
+static unsigned txq_tail;       /* Old data is sent from here. */
+static struct lock txq_lock;    /* Only one thread may wait at once. */
+static struct thread *txq_waiter; /* Thread waiting for room. */
 
 static void set_serial (int bps);
 static void putc_poll (uint8_t);
+static void fill_fifo (void);
+static void fill_fifo_poll (void);
 static void write_ier (void);
 static intr_handler_func serial_interrupt;
 
@@ -68,10 +86,12 @@ init_poll (void)
 {
   ASSERT (mode == UNINIT);
   outb (IER_REG, 0);                    /* Turn off all interrupts. */
-  outb (FCR_REG, 0);                    /* Disable FIFO. */
+  outb (FCR_REG, FCR_ENABLE | FCR_CLEAR_RX | FCR_CLEAR_TX); /* FIFO on. */
   set_serial (9600);                    /* 9.6 kbps, N-8-1. */
   outb (MCR_REG, MCR_OUT2);             /* Required to enable interrupts. */
-  intq_init (&txq);
+  txq_head = txq_tail = 0;
+  lock_init (&txq_lock);
+  txq_waiter = NULL;
   mode = POLL;
 } 
 
@@ -94,49 +114,99 @@ serial_init_queue (void)
   intr_set_level (old_level);
 }
 
-/* Sends BYTE to the serial port. */
+/* Returns true if the transmit buffer is empty. */
+static bool
+txq_empty (void) 
+{
+  return txq_head == txq_tail;
+}
+
+/* Sends the N bytes in BUFFER to the serial port.  In queued
+   mode they are copied into the transmit buffer in as few pieces
+   as possible and sent from the serial interrupt, a FIFO's worth
+   at a time. */
 void
-serial_putc (uint8_t byte) 
+serial_putbuf (const void *buffer_, size_t n) 
 {
+  const uint8_t *buffer = buffer_;
   enum intr_level old_level = intr_disable ();
 
   if (mode != QUEUE)
     {
       /* If we're not set up for interrupt-driven I/O yet,
-         use dumb polling to transmit a byte. */
+         use dumb polling to transmit. */
       if (mode == UNINIT)
         init_poll ();
-      putc_poll (byte); 
+      while (n-- > 0)
+        putc_poll (*buffer++); 
     }
   else 
     {
-      /* Otherwise, queue a byte and update the interrupt enable
-         register. */
-      if (old_level == INTR_OFF && intq_full (&txq)) 
+      while (n > 0) 
         {
-          /* Interrupts are off and the transmit queue is full.
-             If we wanted to wait for the queue to empty,
-             we'd have to reenable interrupts.
-             That's impolite, so we'll send a character via
-             polling instead. */
-          putc_poll (intq_getc (&txq)); 
+          size_t room = TXQ_SIZE - (txq_head - txq_tail);
+          size_t ofs = txq_head % TXQ_SIZE;
+          size_t chunk;
+
+          if (room == 0) 
+            {
+              if (old_level == INTR_OFF || intr_context ())
+                {
+                  /* Interrupts are off and the transmit buffer is
+                     full.  If we wanted to wait for it to drain,
+                     we'd have to reenable interrupts.  That's
+                     impolite, so we'll drain a FIFO's worth via
+                     polling instead. */
+                  fill_fifo_poll ();
+                }
+              else
+                {
+                  write_ier ();
+                  lock_acquire (&txq_lock);
+                  if (txq_head - txq_tail == TXQ_SIZE)
+                    {
+                      txq_waiter = thread_current ();
+                      thread_block ();
+                    }
+                  lock_release (&txq_lock);
+                }
+              continue;
+            }
+
+          chunk = n;
+          if (chunk > room)
+            chunk = room;
+          if (chunk > TXQ_SIZE - ofs)
+            chunk = TXQ_SIZE - ofs;
+          memcpy (txq + ofs, buffer, chunk);
+          txq_head += chunk;
+          buffer += chunk;
+          n -= chunk;
         }
 
-      intq_putc (&txq, byte); 
+      /* Update the interrupt enable register, which starts
+         transmission if the port is idle. */
       write_ier ();
     }
   
   intr_set_level (old_level);
 }
 
+/* Sends BYTE to the serial port. */
+void
+serial_putc (uint8_t byte) 
+{
+  serial_putbuf (&byte, 1);
+}
+
 /* Flushes anything in the serial buffer out the port in polling
    mode. */
 void
 serial_flush (void) 
 {
   enum intr_level old_level = intr_disable ();
-  while (!intq_empty (&txq))
-    putc_poll (intq_getc (&txq));
+  while (!txq_empty ())
+    fill_fifo_poll ();
   intr_set_level (old_level);
 }
 
@@ -182,7 +252,7 @@ write_ier (void)
 
   /* Enable transmit interrupt if we have any characters to
      transmit. */
-  if (!intq_empty (&txq))
+  if (!txq_empty ())
     ier |= IER_XMIT;
 
   /* Enable receive interrupt if we have room to store any
@@ -205,6 +275,34 @@ putc_poll (uint8_t byte)
   outb (THR_REG, byte);
 }
 
+/* If the transmit FIFO is empty, refills it from the transmit
+   buffer.  One check of the line status covers up to FIFO_DEPTH
+   bytes. */
+static void
+fill_fifo (void) 
+{
+  int i;
+
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  if ((inb (LSR_REG) & LSR_THRE) == 0)
+    return;
+  for (i = 0; i < FIFO_DEPTH && !txq_empty (); i++)
+    outb (THR_REG, txq[txq_tail++ % TXQ_SIZE]);
+}
+
+/* Polls the serial port until its transmit FIFO is empty, and
+   then refills it from the transmit buffer. */
+static void
+fill_fifo_poll (void) 
+{
+  ASSERT (intr_get_level () == INTR_OFF);
+
+  while ((inb (LSR_REG) & LSR_THRE) == 0)
+    continue;
+  fill_fifo ();
+}
+
 /* Serial interrupt handler. */
 static void
 serial_interrupt (struct intr_frame *f UNUSED) 
@@ -218,10 +316,14 @@ serial_interrupt (struct intr_frame *f UNUSED)
   while (!input_full () && (inb (LSR_REG) & LSR_DR) != 0)
     input_putc (inb (RBR_REG));
 
-  /* As long as we have a byte to transmit, and the hardware is
-     ready to accept a byte for transmission, transmit a byte. */
-  while (!intq_empty (&txq) && (inb (LSR_REG) & LSR_THRE) != 0) 
-    outb (THR_REG, intq_getc (&txq));
+  /* If the hardware is ready to transmit, hand it as many bytes
+     as its FIFO holds, and wake up any thread waiting for room. */
+  fill_fifo ();
+  if (txq_waiter != NULL && txq_head - txq_tail < TXQ_SIZE) 
+    {
+      thread_unblock (txq_waiter);
+      txq_waiter = NULL;
+    }
 
   /* Update interrupt enable register based on queue status. */
   write_ier ();
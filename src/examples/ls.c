@@ -6,7 +6,11 @@
 
    By default, only the name of each file is printed.  If "-l" is
    given as the first argument, the type, size, and inumber of
-   each file is also printed.  This won't work until project 4. */
+   each file is also printed.  This won't work until project 4.
+
+   Entries are fetched in batches with readdirplus(), which also
+   returns each entry's type, size, and inumber, so a verbose
+   listing costs no extra system calls per file. */
 
 #include <syscall.h>
 #include <stdio.h>
@@ -24,39 +28,29 @@ list_dir (const char *dir, bool verbose)
 
   if (isdir (dir_fd))
     {
-      char name[READDIR_MAX_LEN];
+      struct readdir_entry entries[16];
+      int cnt, i;
 
       printf ("%s", dir);
       if (verbose)
         printf (" (inumber %d)", inumber (dir_fd));
       printf (":\n");
 
-      while (readdir (dir_fd, name)) 
-        {
-          printf ("%s", name); 
-          if (verbose) 
-            {
-              char full_name[128];
-              int entry_fd;
-
-              snprintf (full_name, sizeof full_name, "%s/%s", dir, name);
-              entry_fd = open (full_name);
-
-              printf (": ");
-              if (entry_fd != -1)
-                {
-                  if (isdir (entry_fd))
-                    printf ("directory");
-                  else
-                    printf ("%d-byte file", filesize (entry_fd));
-                  printf (", inumber %d", inumber (entry_fd));
-                }
-              else
-                printf ("open failed");
-              close (entry_fd);
-            }
-          printf ("\n");
-        }
+      while ((cnt = readdirplus (dir_fd, entries, 16)) > 0)
+        for (i = 0; i < cnt; i++)
+          {
+            printf ("%s", entries[i].name); 
+            if (verbose) 
+              {
+                printf (": ");
+                if (entries[i].isdir)
+                  printf ("directory");
+                else
+                  printf ("%u-byte file", entries[i].length);
+                printf (", inumber %d", entries[i].inumber);
+              }
+            printf ("\n");
+          }
     }
   else 
     printf ("%s: not a directory\n", dir);
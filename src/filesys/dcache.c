@@ -0,0 +1,160 @@
+#include "filesys/dcache.h"
+#include <debug.h>
+#include <hash.h>
+#include <list.h>
+#include <string.h>
+#include "filesys/directory.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+
+/* A cached directory entry: the result of looking up NAME in the
+   directory whose inode is at PARENT.  SECTOR is DCACHE_NEGATIVE
+   if the lookup found nothing. */
+struct dentry
+  {
+    struct hash_elem hash_elem;         /* Element in dentries. */
+    struct list_elem lru_elem;          /* Element in lru_list. */
+    block_sector_t parent;              /* Containing directory. */
+    char name[NAME_MAX + 1];            /* Null terminated file name. */
+    block_sector_t sector;              /* Inode sector or negative. */
+  };
+
+static struct hash dentries;            /* All cached entries. */
+static struct list lru_list;            /* Most recently used first. */
+static struct lock dcache_lock;         /* Protects the above. */
+
+static hash_hash_func dentry_hash;
+static hash_less_func dentry_less;
+
+/* Initializes the directory entry cache. */
+void
+dcache_init (void) 
+{
+  hash_init (&dentries, dentry_hash, dentry_less, NULL);
+  list_init (&lru_list);
+  lock_init (&dcache_lock);
+}
+
+/* Returns the cached entry for NAME in PARENT, or a null pointer.
+   The cache lock must be held. */
+static struct dentry *
+find (block_sector_t parent, const char *name)
+{
+  struct dentry key;
+  struct hash_elem *e;
+
+  key.parent = parent;
+  strlcpy (key.name, name, sizeof key.name);
+  e = hash_find (&dentries, &key.hash_elem);
+  return e != NULL ? hash_entry (e, struct dentry, hash_elem) : NULL;
+}
+
+/* Looks up NAME in the directory at sector PARENT.  If the answer
+   is cached, returns true and stores the inode sector into
+   *SECTORP, or DCACHE_NEGATIVE if NAME is known not to exist.
+   Returns false on a cache miss. */
+bool
+dcache_lookup (block_sector_t parent, const char *name,
+               block_sector_t *sectorp)
+{
+  struct dentry *d;
+
+  if (strlen (name) > NAME_MAX)
+    return false;
+
+  lock_acquire (&dcache_lock);
+  d = find (parent, name);
+  if (d != NULL)
+    {
+      list_remove (&d->lru_elem);
+      list_push_front (&lru_list, &d->lru_elem);
+      *sectorp = d->sector;
+    }
+  lock_release (&dcache_lock);
+  return d != NULL;
+}
+
+/* Records that NAME in the directory at sector PARENT refers to
+   the inode at SECTOR, or to nothing if SECTOR is
+   DCACHE_NEGATIVE.  Evicts the least recently used entry if the
+   cache is full. */
+void
+dcache_insert (block_sector_t parent, const char *name,
+               block_sector_t sector)
+{
+  struct dentry *d;
+
+  if (strlen (name) > NAME_MAX)
+    return;
+
+  lock_acquire (&dcache_lock);
+  d = find (parent, name);
+  if (d != NULL)
+    list_remove (&d->lru_elem);
+  else
+    {
+      if (hash_size (&dentries) >= DCACHE_SIZE_MAX)
+        {
+          d = list_entry (list_back (&lru_list), struct dentry, lru_elem);
+          list_remove (&d->lru_elem);
+          hash_delete (&dentries, &d->hash_elem);
+        }
+      else
+        d = malloc (sizeof *d);
+      if (d != NULL)
+        {
+          d->parent = parent;
+          strlcpy (d->name, name, sizeof d->name);
+          hash_insert (&dentries, &d->hash_elem);
+        }
+    }
+
+  if (d != NULL)
+    {
+      d->sector = sector;
+      list_push_front (&lru_list, &d->lru_elem);
+    }
+  lock_release (&dcache_lock);
+}
+
+/* Forgets whatever is cached for NAME in the directory at sector
+   PARENT.  Called whenever the directory entry changes. */
+void
+dcache_invalidate (block_sector_t parent, const char *name)
+{
+  struct dentry *d;
+
+  if (strlen (name) > NAME_MAX)
+    return;
+
+  lock_acquire (&dcache_lock);
+  d = find (parent, name);
+  if (d != NULL)
+    {
+      list_remove (&d->lru_elem);
+      hash_delete (&dentries, &d->hash_elem);
+      free (d);
+    }
+  lock_release (&dcache_lock);
+}
+
+/* Returns a hash of dentry E's parent and name. */
+static unsigned
+dentry_hash (const struct hash_elem *e, void *aux UNUSED)
+{
+  const struct dentry *d = hash_entry (e, struct dentry, hash_elem);
+  return hash_string (d->name) ^ hash_int (d->parent);
+}
+
+/* Returns true if dentry A precedes dentry B. */
+static bool
+dentry_less (const struct hash_elem *a_, const struct hash_elem *b_,
+             void *aux UNUSED)
+{
+  const struct dentry *a = hash_entry (a_, struct dentry, hash_elem);
+  const struct dentry *b = hash_entry (b_, struct dentry, hash_elem);
+
+  if (a->parent != b->parent)
+    return a->parent < b->parent;
+  return strcmp (a->name, b->name) < 0;
+}
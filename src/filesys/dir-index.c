@@ -0,0 +1,360 @@
+#include "filesys/dir-index.h"
+#include <debug.h>
+#include <hash.h>
+#include <string.h>
+#include "filesys/free-map.h"
+#include "filesys/inode.h"
+#include "threads/malloc.h"
+
+/* Hashed index of a large directory.
+
+   The index is a B-tree keyed by the hash of each entry's name,
+   stored in its own file, one node per sector.  Node 0 is always
+   the root.  Leaves map a hash to the byte offset of the entry in
+   the directory file and are chained left to right, so that runs
+   of equal hashes may span several leaves.  Interior nodes map
+   the smallest hash in each child to the child's node number.
+   Removing an entry never merges nodes. */
+
+/* Entries per node. */
+#define INDEX_ENTRY_CNT 63
+
+/* Deepest tree we support: 31-way fanout at worst is plenty for
+   the largest possible directory file. */
+#define INDEX_MAX_DEPTH 8
+
+/* Node number of the root. */
+#define INDEX_ROOT 0
+
+struct index_entry
+  {
+    uint32_t hash;                      /* Name hash or child's minimum. */
+    uint32_t ptr;                       /* Entry offset or child node. */
+  };
+
+/* On-disk index node.
+   Must be exactly BLOCK_SECTOR_SIZE bytes long. */
+struct index_node
+  {
+    uint16_t leaf;                      /* Leaf or interior node? */
+    uint16_t cnt;                       /* Number of entries in use. */
+    uint32_t next;                      /* Next leaf, 0 if last. */
+    struct index_entry entries[INDEX_ENTRY_CNT];
+  };
+
+/* Reads node NO of INDEX into NODE. */
+static bool
+read_node (struct inode *index, uint32_t no, struct index_node *node)
+{
+  return (inode_read_at (index, node, sizeof *node, no * sizeof *node)
+          == sizeof *node);
+}
+
+/* Writes NODE as node NO of INDEX. */
+static bool
+write_node (struct inode *index, uint32_t no, const struct index_node *node)
+{
+  return (inode_write_at (index, node, sizeof *node, no * sizeof *node)
+          == sizeof *node);
+}
+
+/* Returns the number of the next node to be appended to INDEX. */
+static uint32_t
+new_node_no (struct inode *index)
+{
+  return inode_length (index) / sizeof (struct index_node);
+}
+
+/* Returns the position in NODE of the first entry whose hash is
+   greater than HASH, or, if STRICT, greater than or equal to
+   HASH. */
+static int
+upper_bound (const struct index_node *node, uint32_t hash, bool strict)
+{
+  int lo = 0, hi = node->cnt;
+
+  while (lo < hi)
+    {
+      int mid = (lo + hi) / 2;
+      uint32_t h = node->entries[mid].hash;
+      if (h < hash || (!strict && h == hash))
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+  return lo;
+}
+
+/* Returns the child of interior NODE to descend into for HASH.
+   If LEFTMOST, picks the leftmost child that may hold HASH, for
+   lookups; otherwise the rightmost, for insertions. */
+static int
+child_pos (const struct index_node *node, uint32_t hash, bool leftmost)
+{
+  int pos = upper_bound (node, hash, leftmost) - 1;
+  return pos > 0 ? pos : 0;
+}
+
+/* Creates an empty index in a newly allocated file and returns
+   it opened.  Returns a null pointer on disk or memory error. */
+struct inode *
+dir_index_create (void)
+{
+  struct index_node *root;
+  struct inode *index;
+  block_sector_t sector;
+  bool success = false;
+
+  ASSERT (sizeof *root == BLOCK_SECTOR_SIZE);
+
+  if (!free_map_allocate (1, &sector))
+    return NULL;
+  if (!inode_create (sector, 0, -1))
+    {
+      free_map_release (sector, 1);
+      return NULL;
+    }
+  index = inode_open (sector);
+  root = calloc (1, sizeof *root);
+  if (index != NULL)
+    {
+      if (root != NULL)
+        {
+          root->leaf = true;
+          success = write_node (index, INDEX_ROOT, root);
+        }
+      if (!success)
+        {
+          inode_remove (index);
+          inode_close (index);
+          index = NULL;
+        }
+    }
+  free (root);
+  return index;
+}
+
+/* Descends INDEX to the leftmost leaf that may hold HASH, reads
+   it into NODE and stores its number into *NOP. */
+static bool
+find_leaf (struct inode *index, uint32_t hash, struct index_node *node,
+           uint32_t *nop)
+{
+  int depth;
+
+  *nop = INDEX_ROOT;
+  if (!read_node (index, *nop, node))
+    return false;
+  for (depth = 0; !node->leaf; depth++)
+    {
+      if (depth >= INDEX_MAX_DEPTH || node->cnt == 0)
+        return false;
+      *nop = node->entries[child_pos (node, hash, true)].ptr;
+      if (!read_node (index, *nop, node))
+        return false;
+    }
+  return true;
+}
+
+/* Searches INDEX for the entry named NAME.  Each candidate whose
+   hash matches is passed to MATCH, since names may collide.
+   If MATCH accepts one, returns true and stores its directory
+   offset into *OFSP; otherwise returns false. */
+bool
+dir_index_lookup (struct inode *index, const char *name,
+                  dir_index_match_func *match, void *aux, off_t *ofsp)
+{
+  uint32_t hash = hash_string (name);
+  struct index_node *node = malloc (sizeof *node);
+  uint32_t no;
+  bool found = false;
+  int i;
+
+  if (node == NULL || !find_leaf (index, hash, node, &no))
+    goto done;
+
+  for (;;)
+    {
+      for (i = upper_bound (node, hash, true); i < node->cnt; i++)
+        {
+          if (node->entries[i].hash != hash)
+            goto done;
+          if (match (node->entries[i].ptr, aux))
+            {
+              *ofsp = node->entries[i].ptr;
+              found = true;
+              goto done;
+            }
+        }
+      if (node->next == 0 || !read_node (index, node->next, node))
+        goto done;
+    }
+
+ done:
+  free (node);
+  return found;
+}
+
+/* Removes the entry for NAME at directory offset OFS from INDEX.
+   Returns true if it was found. */
+bool
+dir_index_remove (struct inode *index, const char *name, off_t ofs)
+{
+  uint32_t hash = hash_string (name);
+  struct index_node *node = malloc (sizeof *node);
+  uint32_t no;
+  bool success = false;
+  int i;
+
+  if (node == NULL || !find_leaf (index, hash, node, &no))
+    goto done;
+
+  for (;;)
+    {
+      for (i = upper_bound (node, hash, true); i < node->cnt; i++)
+        {
+          if (node->entries[i].hash != hash)
+            goto done;
+          if (node->entries[i].ptr == (uint32_t) ofs)
+            {
+              node->cnt--;
+              memmove (&node->entries[i], &node->entries[i + 1],
+                       (node->cnt - i) * sizeof node->entries[i]);
+              success = write_node (index, no, node);
+              goto done;
+            }
+        }
+      no = node->next;
+      if (no == 0 || !read_node (index, no, node))
+        goto done;
+    }
+
+ done:
+  free (node);
+  return success;
+}
+
+/* Inserts E into NODE at position POS, which must have room. */
+static void
+insert_entry (struct index_node *node, int pos, struct index_entry e)
+{
+  ASSERT (node->cnt < INDEX_ENTRY_CNT);
+  memmove (&node->entries[pos + 1], &node->entries[pos],
+           (node->cnt - pos) * sizeof node->entries[pos]);
+  node->entries[pos] = e;
+  node->cnt++;
+}
+
+/* Adds an entry for NAME at directory offset OFS to INDEX,
+   splitting full nodes on the way back up.
+   Returns true if successful, false on disk or memory error. */
+bool
+dir_index_insert (struct inode *index, const char *name, off_t ofs)
+{
+  uint32_t path[INDEX_MAX_DEPTH];
+  int pos[INDEX_MAX_DEPTH];
+  struct index_node *node, *sibling;
+  struct index_entry e;
+  uint32_t no = INDEX_ROOT, sibling_no;
+  bool success = false;
+  int depth = 0, p, half;
+
+  e.hash = hash_string (name);
+  e.ptr = ofs;
+
+  node = malloc (sizeof *node);
+  sibling = malloc (sizeof *sibling);
+  if (node == NULL || sibling == NULL || !read_node (index, no, node))
+    goto done;
+
+  /* Descend to the leaf, remembering the path. */
+  for (;;)
+    {
+      path[depth] = no;
+      if (node->leaf)
+        {
+          pos[depth] = upper_bound (node, e.hash, false);
+          break;
+        }
+      if (depth + 1 >= INDEX_MAX_DEPTH || node->cnt == 0)
+        goto done;
+      pos[depth] = child_pos (node, e.hash, false);
+      no = node->entries[pos[depth]].ptr;
+      if (!read_node (index, no, node))
+        goto done;
+      depth++;
+    }
+
+  /* Insert, splitting full nodes until one has room. */
+  for (;;)
+    {
+      p = pos[depth];
+      if (node->cnt < INDEX_ENTRY_CNT)
+        {
+          insert_entry (node, p, e);
+          success = write_node (index, path[depth], node);
+          goto done;
+        }
+
+      /* The root stays at node 0: move its contents to a new
+         node, which becomes the root's only child and is split
+         like any other. */
+      if (depth == 0)
+        {
+          uint32_t child_no = new_node_no (index);
+          if (!write_node (index, child_no, node))
+            goto done;
+          memmove (&path[1], &path[0], (INDEX_MAX_DEPTH - 1) * sizeof *path);
+          memmove (&pos[1], &pos[0], (INDEX_MAX_DEPTH - 1) * sizeof *pos);
+          path[1] = child_no;
+          pos[0] = 0;
+          sibling->leaf = false;
+          sibling->cnt = 1;
+          sibling->next = 0;
+          sibling->entries[0].hash = 0;
+          sibling->entries[0].ptr = child_no;
+          if (!write_node (index, INDEX_ROOT, sibling))
+            goto done;
+          depth = 1;
+          p = pos[depth];
+        }
+
+      /* Move the upper half into a new sibling. */
+      half = INDEX_ENTRY_CNT / 2;
+      sibling_no = new_node_no (index);
+      sibling->leaf = node->leaf;
+      sibling->cnt = node->cnt - half;
+      memcpy (sibling->entries, &node->entries[half],
+              sibling->cnt * sizeof *sibling->entries);
+      node->cnt = half;
+      if (node->leaf)
+        {
+          sibling->next = node->next;
+          node->next = sibling_no;
+        }
+      else
+        sibling->next = 0;
+
+      if (p <= half)
+        insert_entry (node, p, e);
+      else
+        insert_entry (sibling, p - half, e);
+
+      if (!write_node (index, sibling_no, sibling)
+          || !write_node (index, path[depth], node))
+        goto done;
+
+      /* Link the sibling into the parent. */
+      e.hash = sibling->entries[0].hash;
+      e.ptr = sibling_no;
+      depth--;
+      pos[depth]++;
+      if (!read_node (index, path[depth], node))
+        goto done;
+    }
+
+ done:
+  free (node);
+  free (sibling);
+  return success;
+}
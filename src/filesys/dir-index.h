@@ -0,0 +1,19 @@
+#ifndef FILESYS_DIR_INDEX_H
+#define FILESYS_DIR_INDEX_H
+
+#include <stdbool.h>
+#include "filesys/off_t.h"
+
+struct inode;
+
+/* Returns true if the directory entry at byte offset OFS is the
+   one being looked for.  AUX is passed through unchanged. */
+typedef bool dir_index_match_func (off_t ofs, void *aux);
+
+struct inode *dir_index_create (void);
+bool dir_index_lookup (struct inode *, const char *name,
+                       dir_index_match_func *, void *aux, off_t *ofsp);
+bool dir_index_insert (struct inode *, const char *name, off_t ofs);
+bool dir_index_remove (struct inode *, const char *name, off_t ofs);
+
+#endif /* filesys/dir-index.h */
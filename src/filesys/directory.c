@@ -2,16 +2,23 @@
 #include <stdio.h>
 #include <string.h>
 #include <list.h>
+#include "filesys/dcache.h"
+#include "filesys/dir-index.h"
 #include "filesys/filesys.h"
 #include "filesys/inode.h"
 #include "threads/malloc.h"
 #include "threads/thread.h"
 
+/* Directories with this many slots or more get a hashed index;
+   smaller ones are searched linearly. */
+#define DIR_INDEX_MIN_ENTRIES 64
+
 /* A directory. */
 struct dir 
   {
     struct inode *inode;                /* Backing store. */
     off_t pos;                          /* Current position. */
+    struct inode *index;                /* Hashed index, opened lazily. */
   };
 
 /* A single directory entry. */
@@ -40,6 +47,7 @@ dir_open (struct inode *inode)
     {
       dir->inode = inode;
       dir->pos = 0;
+      dir->index = NULL;
 
 //printf("OPEN: %d from %d\n",inode_get_open_cnt(dir_get_inode(dir)), inode);
       return dir;
@@ -74,6 +82,7 @@ dir_close (struct dir *dir)
 {
   if (dir != NULL)
     {
+      inode_close (dir->index);
       inode_close (dir->inode);
       free (dir);
     }
@@ -86,21 +95,69 @@ dir_get_inode (struct dir *dir)
   return dir->inode;
 }
 
+/* Returns DIR's hashed index, opening it on first use, or a null
+   pointer if DIR is still searched linearly. */
+static struct inode *
+get_index (struct dir *dir)
+{
+  block_sector_t sector = inode_get_index (dir->inode);
+
+  if (dir->index == NULL && sector != 0)
+    dir->index = inode_open (sector);
+  return dir->index;
+}
+
+/* Candidate check passed to dir_index_lookup(). */
+struct entry_match
+  {
+    struct inode *inode;                /* Directory being searched. */
+    const char *name;                   /* Name looked for. */
+    struct dir_entry *ep;               /* Receives the matching entry. */
+  };
+
+static bool
+entry_matches (off_t ofs, void *aux)
+{
+  struct entry_match *m = aux;
+
+  return (inode_read_at (m->inode, m->ep, sizeof *m->ep, ofs) == sizeof *m->ep
+          && m->ep->in_use && !strcmp (m->name, m->ep->name));
+}
+
 /* Searches DIR for a file with the given NAME.
    If successful, returns true, sets *EP to the directory entry
    if EP is non-null, and sets *OFSP to the byte offset of the
    directory entry if OFSP is non-null.
    otherwise, returns false and ignores EP and OFSP. */
 static bool
-lookup (const struct dir *dir, const char *name,
+lookup (struct dir *dir, const char *name,
         struct dir_entry *ep, off_t *ofsp) 
 {
   struct dir_entry e;
+  struct inode *index;
   size_t ofs;
   
   ASSERT (dir != NULL);
   ASSERT (name != NULL);
 
+  index = get_index (dir);
+  if (index != NULL)
+    {
+      struct entry_match m;
+      off_t index_ofs;
+
+      m.inode = dir->inode;
+      m.name = name;
+      m.ep = &e;
+      if (!dir_index_lookup (index, name, entry_matches, &m, &index_ofs))
+        return false;
+      if (ep != NULL)
+        *ep = e;
+      if (ofsp != NULL)
+        *ofsp = index_ofs;
+      return true;
+    }
+
   for (ofs = 0; inode_read_at (dir->inode, &e, sizeof e, ofs) == sizeof e;
        ofs += sizeof e) 
     if (e.in_use && !strcmp (name, e.name)) 
@@ -114,21 +171,56 @@ lookup (const struct dir *dir, const char *name,
   return false;
 }
 
+/* Builds a hashed index over the entries of DIR, which has grown
+   too large to search linearly.  DIR stays linear on failure. */
+static void
+build_index (struct dir *dir)
+{
+  struct inode *index = dir_index_create ();
+  struct dir_entry e;
+  off_t ofs;
+
+  if (index == NULL)
+    return;
+  for (ofs = 0; inode_read_at (dir->inode, &e, sizeof e, ofs) == sizeof e;
+       ofs += sizeof e)
+    if (e.in_use && !dir_index_insert (index, e.name, ofs))
+      {
+        inode_remove (index);
+        inode_close (index);
+        return;
+      }
+  inode_set_index (dir->inode, inode_get_inumber (index));
+  dir->index = index;
+}
+
 /* Searches DIR for a file with the given NAME
    and returns true if one exists, false otherwise.
    On success, sets *INODE to an inode for the file, otherwise to
-   a null pointer.  The caller must close *INODE. */
+   a null pointer.  The caller must close *INODE.
+   DIR is not const because its index is opened on first use. */
 bool
-dir_lookup (const struct dir *dir, const char *name,
+dir_lookup (struct dir *dir, const char *name,
             struct inode **inode) 
 {
+  block_sector_t parent, sector;
   struct dir_entry e;
 
   ASSERT (dir != NULL);
   ASSERT (name != NULL);
 
-  if (lookup (dir, name, &e, NULL))
-    *inode = inode_open (e.inode_sector);
+  /* Try the dentry cache before searching the directory. */
+  parent = inode_get_inumber (dir->inode);
+  if (!dcache_lookup (parent, name, &sector))
+    {
+      sector = DCACHE_NEGATIVE;
+      if (lookup (dir, name, &e, NULL))
+        sector = e.inode_sector;
+      dcache_insert (parent, name, sector);
+    }
+
+  if (sector != DCACHE_NEGATIVE)
+    *inode = inode_open (sector);
   else
     *inode = NULL;
 
@@ -161,12 +253,14 @@ dir_add (struct dir *dir, const char *name, block_sector_t inode_sector)
 
   /* Set OFS to offset of free slot.
      If there are no free slots, then it will be set to the
-     current end-of-file.
+     current end-of-file.  The search starts from the inode's free
+     slot hint, since every slot before it is in use.
      
      inode_read_at() will only return a short read at end of file.
      Otherwise, we'd need to verify that we didn't get a short
      read due to something intermittent such as low memory. */
-  for (ofs = 0; inode_read_at (dir->inode, &e, sizeof e, ofs) == sizeof e;
+  for (ofs = inode_get_free_hint (dir->inode);
+       inode_read_at (dir->inode, &e, sizeof e, ofs) == sizeof e;
        ofs += sizeof e) 
     if (!e.in_use)
       break;
@@ -176,6 +270,24 @@ dir_add (struct dir *dir, const char *name, block_sector_t inode_sector)
   strlcpy (e.name, name, sizeof e.name);
   e.inode_sector = inode_sector;
   success = inode_write_at (dir->inode, &e, sizeof e, ofs) == sizeof e;
+  if (!success)
+    goto done;
+  inode_set_free_hint (dir->inode, ofs + sizeof e);
+  dcache_invalidate (inode_get_inumber (dir->inode), name);
+
+  /* Keep the index up to date, or start one once DIR is large. */
+  if (get_index (dir) != NULL)
+    {
+      if (!dir_index_insert (dir->index, name, ofs))
+        {
+          e.in_use = false;
+          inode_write_at (dir->inode, &e, sizeof e, ofs);
+          inode_set_free_hint (dir->inode, ofs);
+          success = false;
+        }
+    }
+  else if (ofs / (off_t) sizeof e + 1 >= DIR_INDEX_MIN_ENTRIES)
+    build_index (dir);
 
  done:
   return success;
@@ -229,8 +341,22 @@ dir_remove (struct dir *dir, const char *name)
   e.in_use = false;
   if (inode_write_at (dir->inode, &e, sizeof e, ofs) != sizeof e) 
     goto done;
-
-  /* Remove inode. */
+  if (ofs < inode_get_free_hint (dir->inode))
+    inode_set_free_hint (dir->inode, ofs);
+  dcache_invalidate (inode_get_inumber (dir->inode), name);
+  if (get_index (dir) != NULL)
+    dir_index_remove (dir->index, name, ofs);
+
+  /* Remove inode, along with a removed directory's index. */
+  if (inode_get_index (inode) != 0)
+    {
+      struct inode *index = inode_open (inode_get_index (inode));
+      if (index != NULL)
+        {
+          inode_remove (index);
+          inode_close (index);
+        }
+    }
   inode_remove (inode);
   success = true;
 
@@ -271,6 +397,19 @@ struct dir* dir_chdir(char* path){
    contains no more entries. */
 bool
 dir_readdir (struct dir *dir, char name[NAME_MAX + 1])
+{
+  block_sector_t sector;
+
+  return dir_readdir_sector (dir, name, &sector);
+}
+
+/* Reads the next directory entry in DIR, storing the name in NAME
+   and the sector of the entry's inode in *SECTORP.  Returns true
+   if successful, false if the directory contains no more
+   entries. */
+bool
+dir_readdir_sector (struct dir *dir, char name[NAME_MAX + 1],
+                    block_sector_t *sectorp)
 {
   struct dir_entry e;
 
@@ -280,6 +419,7 @@ dir_readdir (struct dir *dir, char name[NAME_MAX + 1])
       if (e.in_use)
         {
           strlcpy (name, e.name, NAME_MAX + 1);
+          *sectorp = e.inode_sector;
           return true;
         } 
     }
@@ -119,6 +119,87 @@ file_write_at (struct file *file, const void *buffer, off_t size,
   return inode_write_at (file->inode, buffer, size, file_ofs);
 }
 
+/* Truncates FILE to LENGTH bytes, or extends it with zeros if it
+   is shorter.  The file's current position is unaffected.
+   Returns true if successful, false if FILE is a directory, writes
+   to it are denied, or disk allocation fails. */
+bool
+file_truncate (struct file *file, off_t length)
+{
+  ASSERT (file != NULL);
+  if(inode_get_parent(file->inode) != -1) // if directory
+    return false;
+  return inode_truncate (file->inode, length);
+}
+
+/* Reserves disk space for bytes OFFSET through OFFSET + LENGTH of
+   FILE, extending it with zeros if it is shorter.
+   Returns true if successful, false if FILE is a directory, writes
+   to it are denied, the range is negative or ends beyond the
+   largest off_t, or disk allocation fails. */
+bool
+file_allocate (struct file *file, off_t offset, off_t length)
+{
+  ASSERT (file != NULL);
+  if (offset < 0 || length < 0 || length > INT32_MAX - offset)
+    return false;
+  if(inode_get_parent(file->inode) != -1) // if directory
+    return false;
+  return inode_allocate (file->inode, offset + length);
+}
+
+/* Bytes moved per step by file_copy(). */
+#define COPY_CHUNK_SIZE (BLOCK_SECTOR_SIZE * 8)
+
+/* Copies up to LENGTH bytes from SRC, starting at its current
+   position, to DST at its current position, advancing both.  The
+   data moves from one file's cache entries to the other's without
+   leaving the kernel, and DST is extended to cover the whole range
+   in one step before any of it is written.
+   Returns the number of bytes actually copied, which may be less
+   than LENGTH if end of file is reached in SRC or an error
+   occurs, and is 0 if DST cannot be extended to cover the range,
+   including when the range would end beyond the largest off_t. */
+off_t
+file_copy (struct file *dst, struct file *src, off_t length)
+{
+  uint8_t *buffer;
+  off_t copied = 0;
+
+  ASSERT (dst != NULL);
+  ASSERT (src != NULL);
+
+  if (length > inode_length (src->inode) - src->pos)
+    length = inode_length (src->inode) - src->pos;
+  if (length <= 0 || length > INT32_MAX - dst->pos)
+    return 0;
+  if (!file_allocate (dst, dst->pos, length))
+    return 0;
+
+  buffer = malloc (COPY_CHUNK_SIZE);
+  if (buffer == NULL)
+    return 0;
+  while (copied < length)
+    {
+      off_t chunk = length - copied;
+      off_t n;
+
+      if (chunk > COPY_CHUNK_SIZE)
+        chunk = COPY_CHUNK_SIZE;
+      n = inode_read_at (src->inode, buffer, chunk, src->pos);
+      if (n <= 0)
+        break;
+      n = inode_write_at (dst->inode, buffer, n, dst->pos);
+      src->pos += n;
+      dst->pos += n;
+      copied += n;
+      if (n < chunk)
+        break;
+    }
+  free (buffer);
+  return copied;
+}
+
 /* Prevents write operations on FILE's underlying inode
    until file_allow_write() is called or FILE is closed. */
 void
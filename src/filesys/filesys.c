@@ -8,6 +8,7 @@
 #include "filesys/inode.h"
 #include "filesys/directory.h"
 #include "filesys/cache.h"
+#include "filesys/dcache.h"
 
 /* Partition that contains the file system. */
 struct block *fs_device;
@@ -24,6 +25,7 @@ filesys_init (bool format)
     PANIC ("No file system device found, can't initialize file system.");
 
   cache_init();
+  dcache_init ();
   inode_init ();
   free_map_init ();
 
@@ -40,6 +40,44 @@ free_map_allocate (size_t cnt, block_sector_t *sectorp)
   return sector != BITMAP_ERROR;
 }
 
+/* Allocates CNT sectors, not necessarily consecutive, from the
+   free map and stores them into SECTORS[0...CNT-1].  A single
+   consecutive run is preferred so that the data stays laid out
+   sequentially.  The free map file is written only once.
+   Returns true if successful, false if fewer than CNT sectors
+   were free or if the free_map file could not be written, in
+   which case nothing is allocated. */
+bool
+free_map_allocate_many (size_t cnt, block_sector_t *sectors)
+{
+  block_sector_t sector;
+  size_t i;
+
+  sector = bitmap_scan_and_flip (free_map, 0, cnt, false);
+  if (sector != BITMAP_ERROR)
+    for (i = 0; i < cnt; i++)
+      sectors[i] = sector + i;
+  else
+    for (i = 0; i < cnt; i++)
+      {
+        sectors[i] = bitmap_scan_and_flip (free_map, 0, 1, false);
+        if (sectors[i] == BITMAP_ERROR)
+          {
+            while (i-- > 0)
+              bitmap_reset (free_map, sectors[i]);
+            return false;
+          }
+      }
+
+  if (free_map_file != NULL && !bitmap_write (free_map, free_map_file))
+    {
+      for (i = 0; i < cnt; i++)
+        bitmap_reset (free_map, sectors[i]);
+      return false;
+    }
+  return true;
+}
+
 /* Makes CNT sectors starting at SECTOR available for use. */
 void
 free_map_release (block_sector_t sector, size_t cnt)
@@ -49,6 +87,22 @@ free_map_release (block_sector_t sector, size_t cnt)
   bitmap_write (free_map, free_map_file);
 }
 
+/* Makes the CNT sectors in SECTORS[], not necessarily
+   consecutive, available for use, writing the free map file
+   only once. */
+void
+free_map_release_many (const block_sector_t *sectors, size_t cnt)
+{
+  size_t i;
+
+  for (i = 0; i < cnt; i++)
+    {
+      ASSERT (bitmap_test (free_map, sectors[i]));
+      bitmap_reset (free_map, sectors[i]);
+    }
+  bitmap_write (free_map, free_map_file);
+}
+
 /* Opens the free map file and reads it from disk. */
 void
 free_map_open (void) 
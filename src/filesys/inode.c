@@ -15,6 +15,8 @@
 #define MAX_DIRECT (NUM_DIRECT_BLOCK*BLOCK_SECTOR_SIZE)
 #define MAX_INDIRECT (NUM_INDIRECT_BLOCK*BLOCK_SECTOR_SIZE)
 #define NULL_SECTOR 4294967295
+#define MAX_SECTORS (NUM_DIRECT_BLOCK + NUM_INDIRECT_BLOCK \
+                     + NUM_INDIRECT_BLOCK * NUM_INDIRECT_BLOCK)
 
 /* On-disk inode.
    Must be exactly BLOCK_SECTOR_SIZE bytes long. */
@@ -29,10 +31,16 @@ struct inode_disk
     block_sector_t direct_idx[NUM_DIRECT_BLOCK];
     block_sector_t indirect_idx;
     block_sector_t double_indirect_idx;
-    uint32_t unused[112-NUM_DIRECT_BLOCK+10];               /* Not used. */
+
+    /* Taken from the unused space, so inodes written before these
+       existed read them as 0, which means "none" for both. */
+    block_sector_t dir_index;           /* Hashed index, if a large dir. */
+    off_t free_hint;                    /* Dirs: no free slot before this. */
+    uint32_t unused[112-NUM_DIRECT_BLOCK+8];               /* Not used. */
   };
 
 bool inode_extend(struct inode_disk *disk_inode, off_t length);
+static bool inode_resize (struct inode_disk *disk_inode, off_t length);
 
 /* Returns the number of sectors to allocate for an inode SIZE
    bytes long. */
@@ -50,6 +58,7 @@ struct inode
     int open_cnt;                       /* Number of openers. */
     bool removed;                       /* True if deleted, false otherwise. */
     int deny_write_cnt;                 /* 0: writes ok, >0: deny writes. */
+    unsigned write_gen;                 /* Bumped on each content change. */
     struct inode_disk data;             /* Inode content. */
   };
 
@@ -61,27 +70,25 @@ static block_sector_t
 byte_to_sector (const struct inode *inode, off_t pos) 
 {
   block_sector_t indirect_block[NUM_INDIRECT_BLOCK];
-  block_sector_t double_indirect_block[NUM_INDIRECT_BLOCK];
+  size_t idx = pos / BLOCK_SECTOR_SIZE;
   ASSERT (inode != NULL);
   if(pos >= inode->data.length)
     return NULL_SECTOR;
 
   // direct
-  if(pos < MAX_DIRECT)
-    return inode->data.direct_idx[pos / BLOCK_SECTOR_SIZE];
+  if(idx < NUM_DIRECT_BLOCK)
+    return inode->data.direct_idx[idx];
+  idx -= NUM_DIRECT_BLOCK;
   // indirect
-  else if (pos < MAX_DIRECT + MAX_INDIRECT){
+  if (idx < NUM_INDIRECT_BLOCK){
     cache_read(inode->data.indirect_idx, &indirect_block);
-    return indirect_block[pos / BLOCK_SECTOR_SIZE - NUM_DIRECT_BLOCK];
+    return indirect_block[idx];
   }
+  idx -= NUM_INDIRECT_BLOCK;
   // double indirect
-  else{
-    cache_read(inode->data.double_indirect_idx, &double_indirect_block);
-    cache_read(
-      double_indirect_block[(pos/BLOCK_SECTOR_SIZE-MAX_DIRECT-MAX_INDIRECT)/NUM_INDIRECT_BLOCK], 
-      &indirect_block);
-    return indirect_block[(pos/BLOCK_SECTOR_SIZE-MAX_DIRECT-MAX_INDIRECT)%NUM_INDIRECT_BLOCK];
-  }
+  cache_read(inode->data.double_indirect_idx, &indirect_block);
+  cache_read(indirect_block[idx / NUM_INDIRECT_BLOCK], &indirect_block);
+  return indirect_block[idx % NUM_INDIRECT_BLOCK];
 }
 
 /* List of open inodes, so that opening a single inode twice
@@ -166,6 +173,7 @@ inode_open (block_sector_t sector)
   inode->open_cnt = 1;
   inode->deny_write_cnt = 0;
   inode->removed = false;
+  inode->write_gen = 0;
   cache_read(inode->sector, &inode->data);
   return inode;
 }
@@ -192,9 +200,6 @@ inode_get_inumber (const struct inode *inode)
 void
 inode_close (struct inode *inode) 
 {
-  int i,j, num_to_remove;
-  block_sector_t indirect_block[NUM_INDIRECT_BLOCK];
-  block_sector_t double_indirect_block[NUM_INDIRECT_BLOCK];
   /* Ignore null pointer. */
   if (inode == NULL)
     return;
@@ -209,44 +214,7 @@ inode_close (struct inode *inode)
       if (inode->removed) 
         {
           free_map_release (inode->sector, 1);
-          num_to_remove = bytes_to_sectors(inode->data.length);
-          // remove direct
-          for(i=0;i<NUM_DIRECT_BLOCK && num_to_remove;i++){
-            free_map_release(inode->data.direct_idx[i], 1);
-            num_to_remove--;
-          }
-          // remove indirect
-          if(num_to_remove)
-            cache_read(inode->data.indirect_idx,&indirect_block);
-          for(i=0;i<NUM_INDIRECT_BLOCK && num_to_remove;i++){
-            free_map_release(indirect_block[i],1);
-            num_to_remove--;
-          }
-          if(inode->data.indirect_idx != NULL_SECTOR)
-            free_map_release(inode->data.indirect_idx,1);
-
-          //reset
-
-          // remove double indirect
-          if(num_to_remove)
-            cache_read(inode->data.double_indirect_idx,&double_indirect_block);
-          for(i=0;i<NUM_INDIRECT_BLOCK && num_to_remove;i++){
-            if(double_indirect_block[i] != NULL_SECTOR){
-              // reset
-              for(j=0;j<NUM_INDIRECT_BLOCK;j++)
-                indirect_block[j] = NULL_SECTOR;
-              // get and remove single indirect
-              cache_read(double_indirect_block[i], &indirect_block);
-              for(j=0;j<NUM_INDIRECT_BLOCK && num_to_remove;j++){
-                free_map_release(indirect_block[j],1);
-                num_to_remove--;
-              }
-              if(double_indirect_block[i] != NULL_SECTOR)
-                free_map_release(double_indirect_block[i],1);
-            }
-          }
-          if(inode->data.double_indirect_idx != NULL_SECTOR)
-            free_map_release(inode->data.double_indirect_idx,1);
+          inode_resize (&inode->data, 0);
         }
       else
       {
@@ -339,6 +307,7 @@ inode_write_at (struct inode *inode, const void *buffer_, off_t size,
 
   if (inode->deny_write_cnt)
     return 0;
+  inode->write_gen++;
 
   if(inode_length(inode) < size+offset)
     inode_extend(&inode->data, size+offset);
@@ -432,126 +401,251 @@ int inode_get_open_cnt(struct inode* inode){
   return inode->open_cnt;
 }
 
+/* Returns the sector of directory INODE's hashed index, or 0 if
+   it has none.  Sector 0 always holds the free map's inode
+   (FREE_MAP_SECTOR), so no index can be there. */
+block_sector_t inode_get_index(struct inode* inode){
+  return inode->data.dir_index;
+}
+
+/* Records SECTOR as directory INODE's hashed index. */
+void inode_set_index(struct inode* inode, block_sector_t sector){
+  inode->data.dir_index = sector;
+}
+
+/* Returns the offset in directory INODE before which every entry
+   slot is known to be in use.  The hint is kept in the on-disk
+   inode, like the index sector, so that it survives the directory
+   being closed and reopened, as it is by each path lookup. */
+off_t inode_get_free_hint(struct inode* inode){
+  return inode->data.free_hint;
+}
+
+/* Sets directory INODE's free slot hint to OFS. */
+void inode_set_free_hint(struct inode* inode, off_t ofs){
+  inode->data.free_hint = ofs;
+}
+
+/* Returns a number that changes whenever INODE's contents may
+   have changed, for callers that cache them.  It is only
+   meaningful while INODE stays open. */
+unsigned inode_get_write_gen(const struct inode* inode){
+  return inode->write_gen;
+}
+
+/* Truncates INODE to LENGTH bytes, or grows it with zeros if it
+   is shorter.  Index blocks that no longer cover any data are
+   released along with all of their data sectors at once.
+   Returns true if successful, false if writes to INODE are denied
+   or disk allocation fails. */
+bool
+inode_truncate (struct inode *inode, off_t length)
+{
+  static const char zeros[BLOCK_SECTOR_SIZE];
+  off_t tail_end;
+
+  ASSERT (length >= 0);
+  if (inode->deny_write_cnt)
+    return false;
+  inode->write_gen++;
+
+  if (length >= inode_length (inode))
+    return inode_extend (&inode->data, length);
+
+  // zero the tail of the new last sector so growing again reads zeros
+  tail_end = ROUND_UP (length, BLOCK_SECTOR_SIZE);
+  if (tail_end > inode_length (inode))
+    tail_end = inode_length (inode);
+  inode_write_at (inode, zeros, tail_end - length, length);
+  return inode_resize (&inode->data, length);
+}
+
+/* Makes sure every byte of INODE up to LENGTH is backed by an
+   allocated sector, growing INODE if it is shorter, so that later
+   writes within that range cannot fail for lack of space.
+   Returns true if successful, false if writes to INODE are denied
+   or disk allocation fails. */
+bool
+inode_allocate (struct inode *inode, off_t length)
+{
+  ASSERT (length >= 0);
+  if (inode->deny_write_cnt)
+    return false;
+  if (length <= inode_length (inode))
+    return true;
+  return inode_extend (&inode->data, length);
+}
+
 bool
 inode_extend(struct inode_disk *disk_inode, off_t length)
 {
-  int i,j;
-  bool flag = false;
-  int num_to_extend;
-  char zeros[BLOCK_SECTOR_SIZE] = {0};
-  block_sector_t indirect_block[NUM_INDIRECT_BLOCK];
-  block_sector_t double_indirect_block[NUM_INDIRECT_BLOCK];
-
-  //initialization
-  num_to_extend = bytes_to_sectors(length) - bytes_to_sectors(disk_inode->length);
-  ASSERT(num_to_extend>=0);
-  for(i=0;i<NUM_INDIRECT_BLOCK;i++){
-    indirect_block[i]=NULL_SECTOR;
-    double_indirect_block[i]=NULL_SECTOR;
-  }
+  off_t old_length = disk_inode->length;
+
+  ASSERT(length >= old_length);
+  if(inode_resize(disk_inode, length))
+    return true;
+  // roll back whatever was reserved before the failure
+  inode_resize(disk_inode, old_length);
+  return false;
+}
 
-  // read direct index
-  for(i=0;i<NUM_DIRECT_BLOCK&&num_to_extend;i++)
-    if(disk_inode->direct_idx[i] == NULL_SECTOR){
-      if(free_map_allocate(1,&disk_inode->direct_idx[i])){ // set sector
-        cache_write(disk_inode->direct_idx[i], &zeros);
-        num_to_extend--;
-      }
-      else
-        return false;
+/* Reserves a sector for each unallocated slot in IDX[FROM...TO),
+   zero-filled, with one free map update per run of slots. */
+static bool
+reserve_sectors (block_sector_t *idx, size_t from, size_t to)
+{
+  static const char zeros[BLOCK_SECTOR_SIZE];
+  size_t i = from, start;
+
+  while(i < to){
+    while(i < to && idx[i] != NULL_SECTOR)
+      i++;
+    start = i;
+    while(i < to && idx[i] == NULL_SECTOR)
+      i++;
+    if(i > start && !free_map_allocate_many(i - start, idx + start)){
+      while(start < i)
+        idx[start++] = NULL_SECTOR;
+      return false;
     }
+    while(start < i)
+      cache_write(idx[start++], (void*)zeros);
+  }
+  return true;
+}
 
-  // if indirect index already exists
-  if(disk_inode->indirect_idx != NULL_SECTOR && num_to_extend)
-    cache_read(disk_inode->indirect_idx, &indirect_block);
-  // else, allocate indirect index
-  else if(disk_inode->indirect_idx == NULL_SECTOR && num_to_extend){
-    if(free_map_allocate(1,&disk_inode->indirect_idx))  // set sector
-      cache_write(disk_inode->indirect_idx, &indirect_block);
-    else
-      return false;
+/* Releases every allocated slot in IDX[FROM...TO) with one free
+   map update per run of slots, and marks the slots unallocated. */
+static void
+release_sectors (block_sector_t *idx, size_t from, size_t to)
+{
+  size_t i = from, start;
+
+  while(i < to){
+    while(i < to && idx[i] == NULL_SECTOR)
+      i++;
+    start = i;
+    while(i < to && idx[i] != NULL_SECTOR)
+      i++;
+    if(i > start)
+      free_map_release_many(idx + start, i - start);
   }
+  for(i = from; i < to; i++)
+    idx[i] = NULL_SECTOR;
+}
 
-  // allocate indirect index
-  for(i=0;i<NUM_INDIRECT_BLOCK&&num_to_extend;i++){
-    if(indirect_block[i]==NULL_SECTOR){
-      if(free_map_allocate(1, &indirect_block[i])){
-        cache_write(indirect_block[i], &zeros);
-        num_to_extend--;
-        flag = true;
-      }
-      else
-        return false;
-    }
+/* Clamps sector count CNT to the CAP slots starting at BASE. */
+static size_t
+clamp_cnt (size_t cnt, size_t base, size_t cap)
+{
+  if(cnt <= base)
+    return 0;
+  return cnt - base < cap ? cnt - base : cap;
+}
+
+/* Resizes the data held in IDX[0...NUM_INDIRECT_BLOCK) of the
+   index block at *IDX_SECTOR from OLD_CNT to NEW_CNT sectors,
+   counted relative to the block.  With DEPTH 2 the slots are
+   themselves index blocks.  The index block is allocated on first
+   use and released, whole, once it covers no data. */
+static bool
+resize_index_block (block_sector_t *idx_sector, size_t old_cnt,
+                    size_t new_cnt, int depth)
+{
+  block_sector_t idx[NUM_INDIRECT_BLOCK];
+  size_t per_slot = depth == 1 ? 1 : NUM_INDIRECT_BLOCK;
+  size_t i, lo, hi;
+  bool success = true;
+
+  if(old_cnt == new_cnt || (*idx_sector == NULL_SECTOR && new_cnt == 0))
+    return true;
+
+  // index block to be dropped as a whole
+  if(new_cnt == 0 && depth == 1){
+    cache_read(*idx_sector, &idx);
+    release_sectors(idx, 0, old_cnt);
+    free_map_release(*idx_sector, 1);
+    *idx_sector = NULL_SECTOR;
+    return true;
   }
-  // write changed indirect indexes
-  if(flag)
-    cache_write(disk_inode->indirect_idx, &indirect_block);
-
-  // double indirect index already exists
-  if(disk_inode->double_indirect_idx !=NULL_SECTOR && num_to_extend)
-    cache_read(disk_inode->double_indirect_idx, &double_indirect_block);
-  // allocate double indirect index
-  else if(disk_inode->double_indirect_idx == NULL_SECTOR && num_to_extend){
-    if(free_map_allocate(1, &disk_inode->double_indirect_idx))
-      cache_write(disk_inode->double_indirect_idx, &double_indirect_block);
-    else 
+
+  if(*idx_sector == NULL_SECTOR){
+    if(!free_map_allocate(1, idx_sector))
       return false;
+    for(i=0;i<NUM_INDIRECT_BLOCK;i++)
+      idx[i] = NULL_SECTOR;
   }
+  else
+    cache_read(*idx_sector, &idx);
 
-  // allocate double indirect index
-  flag = false;
-  for(i=0;i<NUM_INDIRECT_BLOCK && num_to_extend; i++){
-    // allocate double indirect
-    if(double_indirect_block[i] == NULL_SECTOR){
-      if(free_map_allocate(1,&double_indirect_block[i])){
-        cache_write(double_indirect_block[i], &indirect_block);
-        flag = true;
-      }
-      else
-        return false;
-    }
-
-    // reset stuffs
-    for(j=0;j<NUM_INDIRECT_BLOCK;j++)
-      indirect_block[j] = NULL_SECTOR;
-    bool flag2 = false;
-
-    // (from double idx)indirect index already exists
-    if(double_indirect_block[i] != NULL_SECTOR && num_to_extend )
-      cache_read(double_indirect_block[i], &indirect_block);
-    // else, allocate single indirect
-    else if(double_indirect_block[i] == NULL_SECTOR && num_to_extend){
-      if(free_map_allocate(1,&double_indirect_block[i]))
-        cache_write(double_indirect_block[i],&indirect_block);
-      else
-        return false;
-    }
+  if(depth == 1){
+    if(new_cnt > old_cnt)
+      success = reserve_sectors(idx, old_cnt, new_cnt);
+    else
+      release_sectors(idx, new_cnt, old_cnt);
+  }
+  else{
+    // only the children covering [min, max) sectors change
+    lo = (old_cnt < new_cnt ? old_cnt : new_cnt) / per_slot;
+    hi = DIV_ROUND_UP(old_cnt > new_cnt ? old_cnt : new_cnt, per_slot);
+    for(i = lo; i < hi && success; i++)
+      success = resize_index_block(&idx[i],
+                                   clamp_cnt(old_cnt, i * per_slot, per_slot),
+                                   clamp_cnt(new_cnt, i * per_slot, per_slot),
+                                   1);
+  }
 
-    // allocate single indirects
-    for(j=0;j<NUM_INDIRECT_BLOCK && num_to_extend; j++){
-      if(indirect_block[j] == NULL_SECTOR){
-        if(free_map_allocate(1,&indirect_block[j])){
-          cache_write(indirect_block[j],&zeros);
-          num_to_extend--;
-          flag2 = true;
-        }
-        else
-          return false;
-      }
-    }
-    // write changed (single)indirect blocks
-    if(flag2)
-      cache_write( double_indirect_block[i], &indirect_block);
+  if(new_cnt == 0 && success){
+    free_map_release(*idx_sector, 1);
+    *idx_sector = NULL_SECTOR;
   }
-  // wirte changed double indirect blocks
-  if(flag)
-    cache_write(disk_inode->double_indirect_idx, &double_indirect_block);
+  else
+    cache_write(*idx_sector, &idx);
+  return success;
+}
 
-  // num_to_extend should be 0
-  if(i==NUM_INDIRECT_BLOCK && num_to_extend)
+/* Grows or shrinks DISK_INODE's data to LENGTH bytes.  Sectors are
+   reserved or released a whole index block at a time, with a
+   single free map update for each.  On failure the length is
+   still set to LENGTH, so that shrinking back releases whatever
+   was reserved. */
+static bool
+inode_resize (struct inode_disk *disk_inode, off_t length)
+{
+  size_t old_cnt = bytes_to_sectors(disk_inode->length);
+  size_t new_cnt = bytes_to_sectors(length);
+  size_t base = 0;
+  bool success;
+
+  if(new_cnt > MAX_SECTORS)
     return false;
 
+  // direct
+  if(new_cnt > old_cnt)
+    success = reserve_sectors(disk_inode->direct_idx,
+                              clamp_cnt(old_cnt, 0, NUM_DIRECT_BLOCK),
+                              clamp_cnt(new_cnt, 0, NUM_DIRECT_BLOCK));
+  else{
+    release_sectors(disk_inode->direct_idx,
+                    clamp_cnt(new_cnt, 0, NUM_DIRECT_BLOCK),
+                    clamp_cnt(old_cnt, 0, NUM_DIRECT_BLOCK));
+    success = true;
+  }
+  base += NUM_DIRECT_BLOCK;
+
+  // indirect
+  success = success
+    && resize_index_block(&disk_inode->indirect_idx,
+                          clamp_cnt(old_cnt, base, NUM_INDIRECT_BLOCK),
+                          clamp_cnt(new_cnt, base, NUM_INDIRECT_BLOCK), 1);
+  base += NUM_INDIRECT_BLOCK;
+
+  // double indirect
+  success = success
+    && resize_index_block(&disk_inode->double_indirect_idx,
+                          clamp_cnt(old_cnt, base, MAX_SECTORS - base),
+                          clamp_cnt(new_cnt, base, MAX_SECTORS - base), 2);
+
   disk_inode->length = length;
-  return true;
-}
\ No newline at end of file
+  return success;
+}
@@ -17,9 +17,16 @@ void inode_close (struct inode *);
 void inode_remove (struct inode *);
 off_t inode_read_at (struct inode *, void *, off_t size, off_t offset);
 off_t inode_write_at (struct inode *, const void *, off_t size, off_t offset);
+bool inode_truncate (struct inode *, off_t length);
+bool inode_allocate (struct inode *, off_t length);
 void inode_deny_write (struct inode *);
 void inode_allow_write (struct inode *);
 int inode_get_open_cnt(struct inode* inode);
+block_sector_t inode_get_index(struct inode* inode);
+void inode_set_index(struct inode* inode, block_sector_t sector);
+off_t inode_get_free_hint(struct inode* inode);
+void inode_set_free_hint(struct inode* inode, off_t ofs);
+unsigned inode_get_write_gen(const struct inode* inode);
 off_t inode_length (const struct inode *);
 
 
@@ -28,7 +28,21 @@ enum
     SYS_MKDIR,                  /* Create a directory. */
     SYS_READDIR,                /* Reads a directory entry. */
     SYS_ISDIR,                  /* Tests if a fd represents a directory. */
-    SYS_INUMBER                 /* Returns the inode number for a fd. */
+    SYS_INUMBER,                /* Returns the inode number for a fd. */
+
+    /* Extensions. */
+    SYS_FTRUNCATE,              /* Truncates or extends a file. */
+    SYS_FALLOCATE,              /* Reserves disk space for a file. */
+    SYS_READDIRPLUS,            /* Reads directory entries with attributes. */
+    SYS_PREAD,                  /* Reads from a file at a given position. */
+    SYS_PWRITE,                 /* Writes to a file at a given position. */
+    SYS_READV,                  /* Reads from a file into several buffers. */
+    SYS_WRITEV,                 /* Writes several buffers to a file. */
+    SYS_RING_ENTER,             /* Processes queued ring submissions. */
+    SYS_COPY_FILE_RANGE,        /* Copies between files in the kernel. */
+    SYS_TTYMODE,                /* Sets the console input mode. */
+    SYS_STATS,                  /* Reads system call statistics. */
+    SYS_FORK                    /* Duplicates this process. */
   };
 
 #endif /* lib/syscall-nr.h */
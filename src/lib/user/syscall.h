@@ -2,6 +2,7 @@
 #define __LIB_USER_SYSCALL_H
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <debug.h>
 
 /* Process identifier. */
@@ -15,6 +16,82 @@ typedef int mapid_t;
 /* Maximum characters in a filename written by readdir(). */
 #define READDIR_MAX_LEN 14
 
+/* A directory entry with its attributes, as written by
+   readdirplus(). */
+struct readdir_entry
+  {
+    int inumber;                        /* Inode number. */
+    bool isdir;                         /* Directory or regular file? */
+    unsigned length;                    /* File size in bytes. */
+    char name[READDIR_MAX_LEN + 1];     /* Null terminated file name. */
+  };
+
+/* One buffer of a readv() or writev() call. */
+struct iovec
+  {
+    void *iov_base;                     /* Start of buffer. */
+    size_t iov_len;                     /* Length in bytes. */
+  };
+
+/* Maximum number of buffers in a readv() or writev() call. */
+#define IOV_MAX 1024
+
+/* Operations that may be queued on a ring. */
+#define RING_OP_NOP 0           /* Does nothing; result 0. */
+#define RING_OP_READ 1          /* Like read(), or pread() at OFFSET. */
+#define RING_OP_WRITE 2         /* Like write(), or pwrite() at OFFSET. */
+#define RING_OP_OPEN 3          /* Like open() on the file named BUF. */
+#define RING_OP_CLOSE 4         /* Like close(); result 0 or -1. */
+
+/* A queued operation. */
+struct ring_sqe
+  {
+    int opcode;                         /* RING_OP_*. */
+    int fd;                             /* File descriptor. */
+    void *buf;                          /* Buffer, or name to open. */
+    unsigned len;                       /* Buffer length in bytes. */
+    int offset;                         /* File offset, -1 for current. */
+    unsigned user_data;                 /* Copied into the completion. */
+  };
+
+/* The result of one operation. */
+struct ring_cqe
+  {
+    unsigned user_data;                 /* From the submission. */
+    int res;                            /* What the call would return. */
+  };
+
+/* A submission ring and a completion ring in the caller's memory.
+   The caller queues operations at SQES[SQ_TAIL % ENTRIES] and
+   advances SQ_TAIL, and consumes results from
+   CQES[CQ_HEAD % ENTRIES] and advances CQ_HEAD; ring_enter()
+   advances the other two indexes.  ENTRIES must be a power of
+   2.  Indexes wrap freely. */
+struct ring
+  {
+    unsigned sq_head, sq_tail;          /* Submission ring indexes. */
+    unsigned cq_head, cq_tail;          /* Completion ring indexes. */
+    unsigned entries;                   /* Slots in each ring. */
+    struct ring_sqe *sqes;              /* Submission slots. */
+    struct ring_cqe *cqes;              /* Completion slots. */
+  };
+
+/* Console input modes for ttymode(). */
+#define TTY_RAW 0               /* read() returns keys as typed. */
+#define TTY_CANONICAL 1         /* read() returns whole lines. */
+
+/* Number of latency buckets in a struct syscall_stat. */
+#define STAT_HIST_CNT 32
+
+/* Statistics for one system call, as read by stats(). */
+struct syscall_stat
+  {
+    unsigned long long cnt;             /* Number of calls. */
+    unsigned long long cycles;          /* Total CPU cycles spent. */
+    unsigned hist[STAT_HIST_CNT];       /* Calls taking 2**i to 2**(i+1)-1
+                                           cycles, in hist[i]. */
+  };
+
 /* Typical return values from main() and arguments to exit(). */
 #define EXIT_SUCCESS 0          /* Successful execution. */
 #define EXIT_FAILURE 1          /* Unsuccessful execution. */
@@ -45,4 +122,18 @@ bool readdir (int fd, char name[READDIR_MAX_LEN + 1]);
 bool isdir (int fd);
 int inumber (int fd);
 
+/* Extensions. */
+bool ftruncate (int fd, unsigned length);
+bool fallocate (int fd, unsigned offset, unsigned length);
+int readdirplus (int fd, struct readdir_entry *, unsigned cnt);
+int pread (int fd, void *buffer, unsigned length, unsigned offset);
+int pwrite (int fd, const void *buffer, unsigned length, unsigned offset);
+int readv (int fd, const struct iovec *, int cnt);
+int writev (int fd, const struct iovec *, int cnt);
+int ring_enter (struct ring *, unsigned to_submit);
+int copy_file_range (int in_fd, int out_fd, unsigned length);
+int ttymode (int mode);
+int stats (struct syscall_stat *, unsigned cnt, bool global);
+pid_t fork (void);
+
 #endif /* lib/user/syscall.h */
@@ -0,0 +1,52 @@
+/* Looks up names just before they are created and just after
+   they are removed, so that a stale entry in the directory entry
+   cache, positive or negative, would show up as the wrong answer.
+   Then removes the directory and makes another in its place,
+   which may reuse its sector, and does the same there. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Checks that NAME exists with SIZE bytes. */
+static void
+check_size (const char *name, int size)
+{
+  int fd;
+
+  CHECK ((fd = open (name)) > 1, "open \"%s\"", name);
+  CHECK (filesize (fd) == size, "filesize \"%s\" is %d", name, size);
+  close (fd);
+}
+
+/* Checks that NAME does not exist. */
+static void
+check_missing (const char *name)
+{
+  CHECK (open (name) == -1, "open \"%s\" (must fail)", name);
+}
+
+void
+test_main (void) 
+{
+  CHECK (mkdir ("a"), "mkdir \"a\"");
+  check_missing ("a/x");
+  check_missing ("a/x");
+  CHECK (create ("a/x", 10), "create \"a/x\"");
+  check_size ("a/x", 10);
+  check_size ("a/x", 10);
+  CHECK (remove ("a/x"), "remove \"a/x\"");
+  check_missing ("a/x");
+  CHECK (create ("a/x", 20), "create \"a/x\"");
+  check_size ("a/x", 20);
+  CHECK (remove ("a/x"), "remove \"a/x\"");
+  check_missing ("a/y");
+  CHECK (remove ("a"), "remove \"a\"");
+  check_missing ("a");
+  check_missing ("a/x");
+
+  CHECK (mkdir ("b"), "mkdir \"b\"");
+  check_missing ("b/y");
+  CHECK (create ("b/y", 30), "create \"b/y\"");
+  check_size ("b/y", 30);
+}
@@ -0,0 +1,32 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(dir-dcache) begin
+(dir-dcache) mkdir "a"
+(dir-dcache) open "a/x" (must fail)
+(dir-dcache) open "a/x" (must fail)
+(dir-dcache) create "a/x"
+(dir-dcache) open "a/x"
+(dir-dcache) filesize "a/x" is 10
+(dir-dcache) open "a/x"
+(dir-dcache) filesize "a/x" is 10
+(dir-dcache) remove "a/x"
+(dir-dcache) open "a/x" (must fail)
+(dir-dcache) create "a/x"
+(dir-dcache) open "a/x"
+(dir-dcache) filesize "a/x" is 20
+(dir-dcache) remove "a/x"
+(dir-dcache) open "a/y" (must fail)
+(dir-dcache) remove "a"
+(dir-dcache) open "a" (must fail)
+(dir-dcache) open "a/x" (must fail)
+(dir-dcache) mkdir "b"
+(dir-dcache) open "b/y" (must fail)
+(dir-dcache) create "b/y"
+(dir-dcache) open "b/y"
+(dir-dcache) filesize "b/y" is 30
+(dir-dcache) end
+EOF
+pass;
@@ -0,0 +1,8 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+my ($tree);
+$tree->{'a'}{$_} = [''] foreach qw (0 x 2 3 4 y 6 7 z);
+check_archive ($tree);
+pass;
@@ -0,0 +1,35 @@
+/* Creates files in a directory by path, so that the directory is
+   opened and closed again for each one, removes two of them, and
+   creates three more.  The first two must fill the holes, in order,
+   and the third must go after the last entry, showing that free
+   slots are found correctly even though the directory was not kept
+   open. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char name[READDIR_MAX_LEN + 1];
+  int i, fd;
+
+  CHECK (mkdir ("a"), "mkdir \"a\"");
+  for (i = 0; i < 8; i++)
+    {
+      snprintf (name, sizeof name, "a/%d", i);
+      CHECK (create (name, 0), "create \"%s\"", name);
+    }
+  CHECK (remove ("a/5"), "remove \"a/5\"");
+  CHECK (remove ("a/1"), "remove \"a/1\"");
+  CHECK (create ("a/x", 0), "create \"a/x\"");
+  CHECK (create ("a/y", 0), "create \"a/y\"");
+  CHECK (create ("a/z", 0), "create \"a/z\"");
+
+  CHECK ((fd = open ("a")) > 1, "open \"a\"");
+  while (readdir (fd, name))
+    msg ("readdir \"a\": \"%s\"", name);
+  close (fd);
+}
@@ -0,0 +1,33 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(dir-hint) begin
+(dir-hint) mkdir "a"
+(dir-hint) create "a/0"
+(dir-hint) create "a/1"
+(dir-hint) create "a/2"
+(dir-hint) create "a/3"
+(dir-hint) create "a/4"
+(dir-hint) create "a/5"
+(dir-hint) create "a/6"
+(dir-hint) create "a/7"
+(dir-hint) remove "a/5"
+(dir-hint) remove "a/1"
+(dir-hint) create "a/x"
+(dir-hint) create "a/y"
+(dir-hint) create "a/z"
+(dir-hint) open "a"
+(dir-hint) readdir "a": "0"
+(dir-hint) readdir "a": "x"
+(dir-hint) readdir "a": "2"
+(dir-hint) readdir "a": "3"
+(dir-hint) readdir "a": "4"
+(dir-hint) readdir "a": "y"
+(dir-hint) readdir "a": "6"
+(dir-hint) readdir "a": "7"
+(dir-hint) readdir "a": "z"
+(dir-hint) end
+EOF
+pass;
@@ -0,0 +1,8 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+my ($tree);
+$tree->{'d'}{"f$_"} = [$_ % 3 == 0 ? "\0" : ''] foreach 0...149;
+check_archive ($tree);
+pass;
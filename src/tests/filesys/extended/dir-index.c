@@ -0,0 +1,93 @@
+/* Creates enough files in one directory for it to get a hashed
+   index and for the index's first leaf to split, then removes
+   every third file, checks that lookups of the removed names
+   fail and of the others still succeed, and re-creates the
+   removed files with a different size to check that lookups find
+   the new entries rather than stale ones. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define FILE_CNT 150
+
+static void
+make_name (char *name, size_t size, int i)
+{
+  snprintf (name, size, "/d/f%d", i);
+}
+
+/* Checks that the file numbered I exists with SIZE bytes. */
+static void
+check_size (int i, int size)
+{
+  char name[32];
+  int fd;
+
+  make_name (name, sizeof name, i);
+  CHECK ((fd = open (name)) > 1, "open \"%s\"", name);
+  if (filesize (fd) != size)
+    fail ("\"%s\" has %d bytes, expected %d", name, filesize (fd), size);
+  close (fd);
+}
+
+void
+test_main (void) 
+{
+  char name[32];
+  int i;
+
+  CHECK (mkdir ("/d"), "mkdir \"/d\"");
+
+  msg ("creating %d files in \"/d\"", FILE_CNT);
+  quiet = true;
+  for (i = 0; i < FILE_CNT; i++)
+    {
+      make_name (name, sizeof name, i);
+      CHECK (create (name, 0), "create \"%s\"", name);
+    }
+  quiet = false;
+
+  msg ("checking all of them");
+  quiet = true;
+  for (i = 0; i < FILE_CNT; i++)
+    check_size (i, 0);
+  quiet = false;
+
+  msg ("removing every third file");
+  quiet = true;
+  for (i = 0; i < FILE_CNT; i += 3)
+    {
+      make_name (name, sizeof name, i);
+      CHECK (remove (name), "remove \"%s\"", name);
+    }
+  quiet = false;
+
+  msg ("checking the removed files are gone");
+  quiet = true;
+  for (i = 0; i < FILE_CNT; i++)
+    {
+      make_name (name, sizeof name, i);
+      if (i % 3 == 0 && open (name) != -1)
+        fail ("\"%s\" still exists after remove", name);
+      else if (i % 3 != 0)
+        check_size (i, 0);
+    }
+  quiet = false;
+
+  msg ("re-creating them with 1 byte each");
+  quiet = true;
+  for (i = 0; i < FILE_CNT; i += 3)
+    {
+      make_name (name, sizeof name, i);
+      CHECK (create (name, 1), "create \"%s\"", name);
+    }
+  quiet = false;
+
+  msg ("checking all of them again");
+  quiet = true;
+  for (i = 0; i < FILE_CNT; i++)
+    check_size (i, i % 3 == 0 ? 1 : 0);
+  quiet = false;
+}
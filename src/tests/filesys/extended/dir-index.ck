@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(dir-index) begin
+(dir-index) mkdir "/d"
+(dir-index) creating 150 files in "/d"
+(dir-index) checking all of them
+(dir-index) removing every third file
+(dir-index) checking the removed files are gone
+(dir-index) re-creating them with 1 byte each
+(dir-index) checking all of them again
+(dir-index) end
+EOF
+pass;
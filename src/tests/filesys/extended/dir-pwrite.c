@@ -0,0 +1,23 @@
+/* Tries to pwrite() to and pread() from a directory, which must
+   fail and leave the directory's entries intact. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char buf[16] = "0123456789abcdef";
+  int fd;
+
+  CHECK (mkdir ("a"), "mkdir \"a\"");
+  CHECK (create ("a/b", 512), "create \"a/b\"");
+  CHECK ((fd = open ("a")) > 1, "open \"a\"");
+  CHECK (pwrite (fd, buf, sizeof buf, 0) == -1,
+         "pwrite \"a\" (must return -1)");
+  CHECK (pread (fd, buf, sizeof buf, 0) == -1,
+         "pread \"a\" (must return -1)");
+  close (fd);
+  CHECK ((fd = open ("a/b")) > 1, "open \"a/b\"");
+}
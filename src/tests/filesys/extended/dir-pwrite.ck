@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(dir-pwrite) begin
+(dir-pwrite) mkdir "a"
+(dir-pwrite) create "a/b"
+(dir-pwrite) open "a"
+(dir-pwrite) pwrite "a" (must return -1)
+(dir-pwrite) pread "a" (must return -1)
+(dir-pwrite) open "a/b"
+(dir-pwrite) end
+EOF
+pass;
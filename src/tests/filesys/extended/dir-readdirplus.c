@@ -0,0 +1,46 @@
+/* Lists a directory holding a file and a subdirectory with
+   readdirplus(), which must return each entry's name, type, size
+   and inode number in one call. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Checks that E describes NAME, open as FD, which is a directory
+   if ISDIR, otherwise a file of LENGTH bytes. */
+static void
+check_entry (const struct readdir_entry *e, const char *name, int fd,
+             bool isdir, unsigned length) 
+{
+  if (strcmp (e->name, name))
+    fail ("entry is \"%s\" instead of \"%s\"", e->name, name);
+  if (e->isdir != isdir)
+    fail ("\"%s\" is%s a directory", name, e->isdir ? "" : " not");
+  if (!isdir && e->length != length)
+    fail ("\"%s\" is %u bytes instead of %u", name, e->length, length);
+  if (e->inumber != inumber (fd))
+    fail ("\"%s\" has inode %d instead of %d", name, e->inumber, inumber (fd));
+  msg ("entry \"%s\"", name);
+}
+
+void
+test_main (void) 
+{
+  struct readdir_entry entries[4];
+  int fd, b_fd, c_fd;
+
+  CHECK (mkdir ("a"), "mkdir \"a\"");
+  CHECK (create ("a/b", 512), "create \"a/b\"");
+  CHECK (mkdir ("a/c"), "mkdir \"a/c\"");
+  CHECK ((b_fd = open ("a/b")) > 1, "open \"a/b\"");
+  CHECK ((c_fd = open ("a/c")) > 1, "open \"a/c\"");
+  CHECK ((fd = open ("a")) > 1, "open \"a\"");
+
+  CHECK (readdirplus (fd, entries, 4) == 2, "readdirplus \"a\"");
+  check_entry (&entries[0], "b", b_fd, false, 512);
+  check_entry (&entries[1], "c", c_fd, true, 0);
+  CHECK (readdirplus (fd, entries, 4) == 0, "readdirplus \"a\" at end");
+  CHECK (readdirplus (b_fd, entries, 4) == -1,
+         "readdirplus \"a/b\" (must fail)");
+}
@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(dir-readdirplus) begin
+(dir-readdirplus) mkdir "a"
+(dir-readdirplus) create "a/b"
+(dir-readdirplus) mkdir "a/c"
+(dir-readdirplus) open "a/b"
+(dir-readdirplus) open "a/c"
+(dir-readdirplus) open "a"
+(dir-readdirplus) readdirplus "a"
+(dir-readdirplus) entry "b"
+(dir-readdirplus) entry "c"
+(dir-readdirplus) readdirplus "a" at end
+(dir-readdirplus) readdirplus "a/b" (must fail)
+(dir-readdirplus) end
+EOF
+pass;
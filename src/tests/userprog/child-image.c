@@ -0,0 +1,46 @@
+/* Child process run by the exec-image test.
+   Checks that a table of read-only data several pages long
+   reads back intact.  Given a depth N greater than 0 on its
+   command line, also runs "child-image N-1" and waits for it
+   first, so that N + 1 copies are running at once.  Returns 42
+   if all went well. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <syscall.h>
+#include "tests/lib.h"
+
+const char *test_name = "child-image";
+
+#define X4(N) (N), (N) + 1, (N) + 2, (N) + 3
+#define X16(N) X4 (N), X4 ((N) + 4), X4 ((N) + 8), X4 ((N) + 12)
+#define X64(N) X16 (N), X16 ((N) + 16), X16 ((N) + 32), X16 ((N) + 48)
+#define X256(N) X64 (N), X64 ((N) + 64), X64 ((N) + 128), X64 ((N) + 192)
+#define X1024(N) X256 (N), X256 ((N) + 256), X256 ((N) + 512), \
+                 X256 ((N) + 768)
+
+/* Four pages of read-only data. */
+static const int table[4096] = { X1024 (0), X1024 (1024), X1024 (2048),
+                                 X1024 (3072) };
+
+int
+main (int argc, char *argv[]) 
+{
+  const volatile int *t = table;
+  int depth = argc > 1 ? atoi (argv[1]) : 0;
+  int i;
+
+  for (i = 0; i < 4096; i++)
+    if (t[i] != i)
+      fail ("table[%d] is %d", i, t[i]);
+
+  if (depth > 0)
+    {
+      char cmd_line[32];
+
+      snprintf (cmd_line, sizeof cmd_line, "child-image %d", depth - 1);
+      if (wait (exec (cmd_line)) != 42)
+        fail ("\"%s\" failed", cmd_line);
+    }
+  return 42;
+}
@@ -0,0 +1,38 @@
+/* Writes more text to the console than its output buffer holds,
+   first in a single write() and then as a writev() of one buffer
+   per line, to check that none of it is lost or reordered when
+   the writer has to wait for the buffer to drain. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define LINE_CNT 128
+#define LINE_LEN 80
+
+static char text[LINE_CNT * LINE_LEN];
+
+void
+test_main (void) 
+{
+  struct iovec iov[LINE_CNT];
+  int i, j;
+
+  for (i = 0; i < LINE_CNT; i++)
+    {
+      char *line = text + i * LINE_LEN;
+
+      snprintf (line, 4, "%02d:", i % 100);
+      for (j = 3; j < LINE_LEN - 1; j++)
+        line[j] = 'a' + (i + j) % 26;
+      line[LINE_LEN - 1] = '\n';
+      iov[i].iov_base = line;
+      iov[i].iov_len = LINE_LEN;
+    }
+
+  CHECK (write (STDOUT_FILENO, text, sizeof text) == sizeof text,
+         "write %zu bytes to console", sizeof text);
+  CHECK (writev (STDOUT_FILENO, iov, LINE_CNT) == sizeof text,
+         "writev %zu bytes to console", sizeof text);
+}
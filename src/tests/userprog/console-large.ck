@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+
+my ($text) = "";
+for my $i (0...127) {
+    $text .= sprintf ("%02d:", $i % 100);
+    $text .= chr (ord ('a') + ($i + $_) % 26) foreach 3...78;
+    $text .= "\n";
+}
+
+check_expected ([<<EOF]);
+(console-large) begin
+(console-large) write 10240 bytes to console
+$text(console-large) writev 10240 bytes to console
+$text(console-large) end
+console-large: exit(0)
+EOF
+pass;
@@ -0,0 +1,35 @@
+/* Copies "sample.txt" to a new file with copy_file_range(), asking
+   for more bytes than there are, which must copy the whole file
+   and advance both file positions. */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  int in, out, byte_cnt;
+
+  CHECK ((in = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (create ("copy.txt", 0), "create \"copy.txt\"");
+  CHECK ((out = open ("copy.txt")) > 1, "open \"copy.txt\"");
+
+  byte_cnt = copy_file_range (in, out, 4096);
+  if (byte_cnt != sizeof sample - 1)
+    fail ("copy_file_range() returned %d instead of %zu",
+          byte_cnt, sizeof sample - 1);
+  msg ("copy \"sample.txt\" to \"copy.txt\"");
+  if (tell (in) != sizeof sample - 1 || tell (out) != sizeof sample - 1)
+    fail ("file positions are %u and %u instead of %zu",
+          tell (in), tell (out), sizeof sample - 1);
+
+  byte_cnt = copy_file_range (in, out, 4096);
+  if (byte_cnt != 0)
+    fail ("copy_file_range() at end of file returned %d", byte_cnt);
+  msg ("copy at end of file");
+  close (out);
+
+  check_file ("copy.txt", sample, sizeof sample - 1);
+}
@@ -0,0 +1,44 @@
+/* Runs several copies of one executable at once, so that they
+   share its read-only pages.  Then copies an executable to a new
+   file and runs it, writes a different executable over the copy,
+   and runs the copy again, which must run the new program rather
+   than any pages cached from the old one. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Copies the contents of file FROM over the start of file TO,
+   creating TO if it does not exist. */
+static void
+copy_file (const char *from, const char *to) 
+{
+  static char buf[1024];
+  int from_fd, to_fd, n;
+
+  create (to, 0);
+  CHECK ((from_fd = open (from)) > 1, "open \"%s\"", from);
+  CHECK ((to_fd = open (to)) > 1, "open \"%s\"", to);
+  while ((n = read (from_fd, buf, sizeof buf)) > 0)
+    CHECK (write (to_fd, buf, n) == n, "write \"%s\"", to);
+  close (from_fd);
+  close (to_fd);
+}
+
+void
+test_main (void) 
+{
+  CHECK (wait (exec ("child-image 3")) == 42, "exec \"child-image 3\"");
+
+  msg ("copy \"child-image\" to \"child-copy\"");
+  quiet = true;
+  copy_file ("child-image", "child-copy");
+  quiet = false;
+  CHECK (wait (exec ("child-copy")) == 42, "exec \"child-copy\"");
+
+  msg ("copy \"child-simple\" over \"child-copy\"");
+  quiet = true;
+  copy_file ("child-simple", "child-copy");
+  quiet = false;
+  CHECK (wait (exec ("child-copy")) == 81, "exec \"child-copy\"");
+}
@@ -0,0 +1,22 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(exec-image) begin
+(exec-image) exec "child-image 3"
+child-image: exit(42)
+child-image: exit(42)
+child-image: exit(42)
+child-image: exit(42)
+(exec-image) copy "child-image" to "child-copy"
+(exec-image) exec "child-copy"
+child-copy: exit(42)
+(exec-image) copy "child-simple" over "child-copy"
+(exec-image) exec "child-copy"
+(child-simple) run
+child-copy: exit(81)
+(exec-image) end
+exec-image: exit(0)
+EOF
+pass;
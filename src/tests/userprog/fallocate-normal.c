@@ -0,0 +1,32 @@
+/* Reserves space past the end of an empty file with fallocate(),
+   which must extend the file with zeros without moving the file
+   position, and never shrinks the file. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  static char zeros[1100];
+  static char buf[1100];
+  int handle, byte_cnt;
+
+  CHECK (create ("test.txt", 0), "create \"test.txt\"");
+  CHECK ((handle = open ("test.txt")) > 1, "open \"test.txt\"");
+  CHECK (fallocate (handle, 100, 1000), "fallocate 1000 bytes at offset 100");
+  if (filesize (handle) != 1100)
+    fail ("file size is %d instead of 1100", filesize (handle));
+  if (tell (handle) != 0)
+    fail ("fallocate() moved the file position to %u", tell (handle));
+  CHECK (fallocate (handle, 0, 10), "fallocate 10 bytes at offset 0");
+  if (filesize (handle) != 1100)
+    fail ("file size is %d instead of 1100", filesize (handle));
+
+  byte_cnt = read (handle, buf, sizeof buf);
+  if (byte_cnt != sizeof buf)
+    fail ("read() returned %d instead of %zu", byte_cnt, sizeof buf);
+  compare_bytes (buf, zeros, sizeof buf, 0, "test.txt");
+  msg ("read back zeros");
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(fallocate-normal) begin
+(fallocate-normal) create "test.txt"
+(fallocate-normal) open "test.txt"
+(fallocate-normal) fallocate 1000 bytes at offset 100
+(fallocate-normal) fallocate 10 bytes at offset 0
+(fallocate-normal) read back zeros
+(fallocate-normal) end
+fallocate-normal: exit(0)
+EOF
+pass;
@@ -0,0 +1,23 @@
+/* Tries to fallocate() a range that ends past the largest file
+   offset, which must fail without changing the file. */
+
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  int handle;
+
+  CHECK (create ("test.txt", 0), "create \"test.txt\"");
+  CHECK ((handle = open ("test.txt")) > 1, "open \"test.txt\"");
+  CHECK (!fallocate (handle, INT32_MAX, 1),
+         "fallocate 1 byte at largest offset (must fail)");
+  CHECK (!fallocate (handle, 1, INT32_MAX),
+         "fallocate largest length at offset 1 (must fail)");
+  if (filesize (handle) != 0)
+    fail ("file size is %d instead of 0", filesize (handle));
+  msg ("file still empty");
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(fallocate-overflow) begin
+(fallocate-overflow) create "test.txt"
+(fallocate-overflow) open "test.txt"
+(fallocate-overflow) fallocate 1 byte at largest offset (must fail)
+(fallocate-overflow) fallocate largest length at offset 1 (must fail)
+(fallocate-overflow) file still empty
+(fallocate-overflow) end
+fallocate-overflow: exit(0)
+EOF
+pass;
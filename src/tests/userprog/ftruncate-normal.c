@@ -0,0 +1,34 @@
+/* Shrinks a file with ftruncate(), then grows it again, which
+   must bring back zeros rather than the old contents. */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  static char zeros[100];
+  char buf[100];
+  int handle, byte_cnt;
+
+  CHECK (create ("test.txt", 0), "create \"test.txt\"");
+  CHECK ((handle = open ("test.txt")) > 1, "open \"test.txt\"");
+  if (write (handle, sample, sizeof sample - 1) != sizeof sample - 1)
+    fail ("write() failed");
+
+  CHECK (ftruncate (handle, 10), "ftruncate to 10 bytes");
+  if (filesize (handle) != 10)
+    fail ("file size is %d instead of 10", filesize (handle));
+  CHECK (ftruncate (handle, 100), "ftruncate to 100 bytes");
+  if (filesize (handle) != 100)
+    fail ("file size is %d instead of 100", filesize (handle));
+
+  byte_cnt = pread (handle, buf, sizeof buf, 0);
+  if (byte_cnt != sizeof buf)
+    fail ("pread() returned %d instead of %zu", byte_cnt, sizeof buf);
+  compare_bytes (buf, sample, 10, 0, "test.txt");
+  compare_bytes (buf + 10, zeros, 90, 10, "test.txt");
+  msg ("read back");
+}
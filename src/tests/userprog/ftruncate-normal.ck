@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(ftruncate-normal) begin
+(ftruncate-normal) create "test.txt"
+(ftruncate-normal) open "test.txt"
+(ftruncate-normal) ftruncate to 10 bytes
+(ftruncate-normal) ftruncate to 100 bytes
+(ftruncate-normal) read back
+(ftruncate-normal) end
+ftruncate-normal: exit(0)
+EOF
+pass;
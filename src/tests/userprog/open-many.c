@@ -0,0 +1,60 @@
+/* Opens more files than fit in the initial file descriptor
+   table, closes them in mixed order, and opens them again.
+   Every open must succeed with a distinct descriptor, and the
+   descriptors past the first table must still work. */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define FILE_CNT 40
+
+static int fds[FILE_CNT];
+
+static void
+open_all (const char *what)
+{
+  int i, j;
+
+  for (i = 0; i < FILE_CNT; i++)
+    if (fds[i] < 0)
+      {
+        fds[i] = open ("sample.txt");
+        if (fds[i] < 2)
+          fail ("open #%d returned %d", i, fds[i]);
+      }
+  for (i = 0; i < FILE_CNT; i++)
+    for (j = i + 1; j < FILE_CNT; j++)
+      if (fds[i] == fds[j])
+        fail ("opens #%d and #%d both returned %d", i, j, fds[i]);
+  msg ("%s %d files", what, FILE_CNT);
+}
+
+void
+test_main (void) 
+{
+  int i;
+
+  for (i = 0; i < FILE_CNT; i++)
+    fds[i] = -1;
+  open_all ("open");
+
+  /* Close the odd ones from the top down, then every fourth. */
+  for (i = FILE_CNT - 1; i >= 0; i--)
+    if (i % 2)
+      {
+        close (fds[i]);
+        fds[i] = -1;
+      }
+  for (i = 0; i < FILE_CNT; i += 4)
+    {
+      close (fds[i]);
+      fds[i] = -1;
+    }
+  open_all ("reopen");
+
+  check_file_handle (fds[FILE_CNT - 1], "sample.txt", sample, sizeof sample - 1);
+  for (i = 0; i < FILE_CNT; i++)
+    close (fds[i]);
+}
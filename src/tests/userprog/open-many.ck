@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(open-many) begin
+(open-many) open 40 files
+(open-many) reopen 40 files
+(open-many) verified contents of "sample.txt"
+(open-many) end
+open-many: exit(0)
+EOF
+pass;
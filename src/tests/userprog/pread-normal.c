@@ -0,0 +1,32 @@
+/* Reads from the middle of "sample.txt" with pread(), which must
+   return the bytes at the given offset without moving the file
+   position, and 0 at end of file. */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char buf[32];
+  int handle, byte_cnt;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+
+  byte_cnt = pread (handle, buf, sizeof buf, 10);
+  if (byte_cnt != sizeof buf)
+    fail ("pread() returned %d instead of %zu", byte_cnt, sizeof buf);
+  compare_bytes (buf, sample + 10, sizeof buf, 10, "sample.txt");
+  msg ("pread %zu bytes at offset 10", sizeof buf);
+
+  if (tell (handle) != 0)
+    fail ("pread() moved the file position to %u", tell (handle));
+  msg ("file position unchanged");
+
+  byte_cnt = pread (handle, buf, sizeof buf, sizeof sample - 1);
+  if (byte_cnt != 0)
+    fail ("pread() at end of file returned %d", byte_cnt);
+  msg ("pread at end of file");
+}
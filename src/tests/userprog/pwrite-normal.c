@@ -0,0 +1,41 @@
+/* Writes past the end of an empty file with pwrite(), which must
+   extend the file with zeros up to the given offset without
+   moving the file position. */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  static char zeros[100];
+  char buf[100 + sizeof sample];
+  int handle, byte_cnt;
+
+  CHECK (create ("test.txt", 0), "create \"test.txt\"");
+  CHECK ((handle = open ("test.txt")) > 1, "open \"test.txt\"");
+
+  byte_cnt = pwrite (handle, sample, sizeof sample - 1, 100);
+  if (byte_cnt != sizeof sample - 1)
+    fail ("pwrite() returned %d instead of %zu", byte_cnt, sizeof sample - 1);
+  msg ("pwrite sample at offset 100");
+
+  if (tell (handle) != 0)
+    fail ("pwrite() moved the file position to %u", tell (handle));
+  msg ("file position unchanged");
+
+  if (filesize (handle) != 100 + sizeof sample - 1)
+    fail ("file size is %d instead of %zu",
+          filesize (handle), 100 + sizeof sample - 1);
+  msg ("file extended");
+
+  byte_cnt = read (handle, buf, sizeof buf - 1);
+  if (byte_cnt != 100 + sizeof sample - 1)
+    fail ("read() returned %d instead of %zu",
+          byte_cnt, 100 + sizeof sample - 1);
+  compare_bytes (buf, zeros, 100, 0, "test.txt");
+  compare_bytes (buf + 100, sample, sizeof sample - 1, 100, "test.txt");
+  msg ("read back");
+}
@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(pwrite-normal) begin
+(pwrite-normal) create "test.txt"
+(pwrite-normal) open "test.txt"
+(pwrite-normal) pwrite sample at offset 100
+(pwrite-normal) file position unchanged
+(pwrite-normal) file extended
+(pwrite-normal) read back
+(pwrite-normal) end
+pwrite-normal: exit(0)
+EOF
+pass;
@@ -0,0 +1,29 @@
+/* Reads "sample.txt" into three buffers, one of them empty, with
+   a single readv(), which must fill them in order. */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char a[10], b[1], c[50];
+  struct iovec iov[3] = {{a, sizeof a}, {b, 0}, {c, sizeof c}};
+  int handle, byte_cnt;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+
+  byte_cnt = readv (handle, iov, 3);
+  if (byte_cnt != sizeof a + sizeof c)
+    fail ("readv() returned %d instead of %zu", byte_cnt, sizeof a + sizeof c);
+  compare_bytes (a, sample, sizeof a, 0, "sample.txt");
+  compare_bytes (c, sample + sizeof a, sizeof c, sizeof a, "sample.txt");
+  msg ("readv 3 buffers");
+
+  if (tell (handle) != sizeof a + sizeof c)
+    fail ("file position is %u instead of %zu",
+          tell (handle), sizeof a + sizeof c);
+  msg ("file position advanced");
+}
@@ -0,0 +1,13 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(readv-normal) begin
+(readv-normal) open "sample.txt"
+(readv-normal) readv 3 buffers
+(readv-normal) file position advanced
+(readv-normal) end
+readv-normal: exit(0)
+EOF
+pass;
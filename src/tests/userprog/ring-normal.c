@@ -0,0 +1,69 @@
+/* Opens "sample.txt" through a ring, then reads from it, does
+   nothing and closes it with three operations submitted in one
+   ring_enter(), checking each completion. */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+static struct ring_sqe sqes[4];
+static struct ring_cqe cqes[4];
+static struct ring ring = {0, 0, 0, 0, 4, sqes, cqes};
+
+/* Queues an operation on the ring. */
+static void
+submit (int opcode, int fd, void *buf, unsigned len, int offset,
+        unsigned user_data) 
+{
+  struct ring_sqe *sqe = &sqes[ring.sq_tail++ % ring.entries];
+
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->buf = buf;
+  sqe->len = len;
+  sqe->offset = offset;
+  sqe->user_data = user_data;
+}
+
+/* Consumes the next completion, which must be for USER_DATA, and
+   returns its result. */
+static int
+complete (unsigned user_data) 
+{
+  struct ring_cqe *cqe;
+
+  if (ring.cq_head == ring.cq_tail)
+    fail ("no completion for operation %u", user_data);
+  cqe = &cqes[ring.cq_head++ % ring.entries];
+  if (cqe->user_data != user_data)
+    fail ("completion for operation %u instead of %u",
+          cqe->user_data, user_data);
+  return cqe->res;
+}
+
+void
+test_main (void) 
+{
+  char buf[32];
+  int handle, result;
+
+  submit (RING_OP_OPEN, 0, (void *) "sample.txt", 0, -1, 1);
+  CHECK (ring_enter (&ring, 1) == 1, "submit open");
+  CHECK ((handle = complete (1)) > 1, "open \"sample.txt\"");
+
+  submit (RING_OP_READ, handle, buf, sizeof buf, 10, 2);
+  submit (RING_OP_NOP, 0, NULL, 0, -1, 3);
+  submit (RING_OP_CLOSE, handle, NULL, 0, -1, 4);
+  CHECK (ring_enter (&ring, 3) == 3, "submit read, nop and close");
+
+  result = complete (2);
+  if (result != sizeof buf)
+    fail ("read returned %d instead of %zu", result, sizeof buf);
+  compare_bytes (buf, sample + 10, sizeof buf, 10, "sample.txt");
+  msg ("read %zu bytes at offset 10", sizeof buf);
+  CHECK (complete (3) == 0, "nop");
+  CHECK (complete (4) == 0, "close");
+  if (ring.sq_head != ring.sq_tail)
+    fail ("submission ring not empty");
+}
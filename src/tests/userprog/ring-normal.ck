@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(ring-normal) begin
+(ring-normal) submit open
+(ring-normal) open "sample.txt"
+(ring-normal) submit read, nop and close
+(ring-normal) read 32 bytes at offset 10
+(ring-normal) nop
+(ring-normal) close
+(ring-normal) end
+ring-normal: exit(0)
+EOF
+pass;
@@ -0,0 +1,48 @@
+/* Makes a known number of tell() calls and checks that stats()
+   counts them, both for this process and for the system as a
+   whole, and that each call lands in one latency bucket. */
+
+#include <syscall.h>
+#include <syscall-nr.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define STAT_CNT (SYS_TELL + 1)
+
+/* Returns the number of calls in STAT's latency buckets. */
+static unsigned long long
+hist_total (const struct syscall_stat *stat) 
+{
+  unsigned long long total = 0;
+  int i;
+
+  for (i = 0; i < STAT_HIST_CNT; i++)
+    total += stat->hist[i];
+  return total;
+}
+
+void
+test_main (void) 
+{
+  struct syscall_stat before[STAT_CNT], after[STAT_CNT], global[STAT_CNT];
+  int handle, i;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (stats (before, STAT_CNT, false) == STAT_CNT, "read process stats");
+  for (i = 0; i < 5; i++)
+    tell (handle);
+  CHECK (stats (after, STAT_CNT, false) == STAT_CNT, "read process stats again");
+  CHECK (stats (global, STAT_CNT, true) == STAT_CNT, "read global stats");
+
+  if (after[SYS_TELL].cnt - before[SYS_TELL].cnt != 5)
+    fail ("%llu tell() calls counted instead of 5",
+          after[SYS_TELL].cnt - before[SYS_TELL].cnt);
+  if (after[SYS_TELL].cycles <= before[SYS_TELL].cycles)
+    fail ("no cycles counted for tell()");
+  if (hist_total (&after[SYS_TELL]) != after[SYS_TELL].cnt)
+    fail ("latency buckets hold %llu calls instead of %llu",
+          hist_total (&after[SYS_TELL]), after[SYS_TELL].cnt);
+  if (global[SYS_TELL].cnt < after[SYS_TELL].cnt)
+    fail ("global stats count fewer calls than process stats");
+  msg ("5 tell() calls counted");
+}
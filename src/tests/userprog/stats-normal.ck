@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(stats-normal) begin
+(stats-normal) open "sample.txt"
+(stats-normal) read process stats
+(stats-normal) read process stats again
+(stats-normal) read global stats
+(stats-normal) 5 tell() calls counted
+(stats-normal) end
+stats-normal: exit(0)
+EOF
+pass;
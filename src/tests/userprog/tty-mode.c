@@ -0,0 +1,40 @@
+/* Switches the console between raw and canonical input, checking
+   that each switch returns the previous mode and that a bad mode
+   is rejected without changing it.  In each mode, tries 0-byte
+   reads of the console, which should return 0 at once rather
+   than wait for input. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+/* Checks that 0-byte reads of the console return 0 without
+   touching the buffer. */
+static void
+check_zero_reads (void)
+{
+  char buf = 123;
+  struct iovec iov;
+
+  CHECK (read (STDIN_FILENO, &buf, 0) == 0, "read 0 bytes from console");
+  iov.iov_base = &buf;
+  iov.iov_len = 0;
+  CHECK (readv (STDIN_FILENO, &iov, 1) == 0, "readv 0 bytes from console");
+  if (buf != 123)
+    fail ("0-byte read modified buffer");
+}
+
+void
+test_main (void) 
+{
+  CHECK (ttymode (TTY_CANONICAL) == TTY_RAW, "ttymode canonical, was raw");
+  check_zero_reads ();
+  CHECK (ttymode (TTY_CANONICAL) == TTY_CANONICAL,
+         "ttymode canonical, was canonical");
+  CHECK (ttymode (2) == -1, "ttymode 2 (must fail)");
+  CHECK (ttymode (-1) == -1, "ttymode -1 (must fail)");
+  CHECK (ttymode (TTY_RAW) == TTY_CANONICAL, "ttymode raw, was canonical");
+  check_zero_reads ();
+  CHECK (ttymode (TTY_RAW) == TTY_RAW, "ttymode raw, was raw");
+}
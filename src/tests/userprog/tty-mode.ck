@@ -0,0 +1,20 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(tty-mode) begin
+(tty-mode) ttymode canonical, was raw
+(tty-mode) read 0 bytes from console
+(tty-mode) readv 0 bytes from console
+(tty-mode) ttymode canonical, was canonical
+(tty-mode) ttymode 2 (must fail)
+(tty-mode) ttymode -1 (must fail)
+(tty-mode) ttymode raw, was canonical
+(tty-mode) read 0 bytes from console
+(tty-mode) readv 0 bytes from console
+(tty-mode) ttymode raw, was raw
+(tty-mode) end
+tty-mode: exit(0)
+EOF
+pass;
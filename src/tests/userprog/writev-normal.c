@@ -0,0 +1,30 @@
+/* Writes "sample.txt" to a new file from three buffers, one of
+   them empty, with a single writev(). */
+
+#include <syscall.h>
+#include "tests/userprog/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  struct iovec iov[3] =
+    {
+      {sample, 20},
+      {sample + 20, 0},
+      {sample + 20, sizeof sample - 1 - 20},
+    };
+  int handle, byte_cnt;
+
+  CHECK (create ("test.txt", 0), "create \"test.txt\"");
+  CHECK ((handle = open ("test.txt")) > 1, "open \"test.txt\"");
+
+  byte_cnt = writev (handle, iov, 3);
+  if (byte_cnt != sizeof sample - 1)
+    fail ("writev() returned %d instead of %zu", byte_cnt, sizeof sample - 1);
+  msg ("writev 3 buffers");
+  close (handle);
+
+  check_file ("test.txt", sample, sizeof sample - 1);
+}
@@ -0,0 +1,29 @@
+/* Tries to writev() at a file position so close to the largest
+   file offset that the write would run past it, which must fail
+   without writing or allocating anything. */
+
+#include <stdint.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  char buf[16] = "0123456789abcdef";
+  struct iovec iov[2] = {{buf, sizeof buf}, {buf, sizeof buf}};
+  int handle, byte_cnt;
+
+  CHECK (create ("test.txt", 0), "create \"test.txt\"");
+  CHECK ((handle = open ("test.txt")) > 1, "open \"test.txt\"");
+
+  seek (handle, INT32_MAX - 16);
+  byte_cnt = writev (handle, iov, 2);
+  if (byte_cnt != -1)
+    fail ("writev() returned %d instead of -1", byte_cnt);
+  msg ("writev past largest offset");
+
+  if (filesize (handle) != 0)
+    fail ("file size is %d instead of 0", filesize (handle));
+  msg ("file still empty");
+}
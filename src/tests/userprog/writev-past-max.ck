@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(writev-past-max) begin
+(writev-past-max) create "test.txt"
+(writev-past-max) open "test.txt"
+(writev-past-max) writev past largest offset
+(writev-past-max) file still empty
+(writev-past-max) end
+writev-past-max: exit(0)
+EOF
+pass;
@@ -0,0 +1,52 @@
+/* Child process of page-pageout.
+   Rewrites 768 kB of memory several times over, checking before
+   each pass that the previous one's data is all there.  With
+   several of these running at once, memory runs short, so pages
+   are written out in the background while their owners are
+   still reading and writing them.  Returns the number given on
+   its command line. */
+
+#include <stdlib.h>
+#include <string.h>
+#include "tests/lib.h"
+
+const char *test_name = "child-pageout";
+
+#define PAGE_SIZE 4096
+#define SIZE (768 * 1024)
+#define PAGE_CNT (SIZE / PAGE_SIZE)
+#define PASS_CNT 3
+
+static char buf[SIZE];
+
+/* Returns the byte for page PG of child KEY in pass PASS. */
+static char
+pattern (int key, int pg, int pass) 
+{
+  return key * 31 + pg * 7 + pass;
+}
+
+int
+main (int argc, char *argv[]) 
+{
+  int key = atoi (argv[argc - 1]);
+  int pass, pg, ofs;
+
+  for (pass = 0; pass < PASS_CNT; pass++)
+    for (pg = 0; pg < PAGE_CNT; pg++)
+      {
+        char *p = buf + pg * PAGE_SIZE;
+
+        if (pass > 0)
+          for (ofs = 0; ofs < PAGE_SIZE; ofs++)
+            if (p[ofs] != pattern (key, pg, pass - 1))
+              fail ("byte %d of page %d is wrong in pass %d", ofs, pg, pass);
+        memset (p, pattern (key, pg, pass), PAGE_SIZE);
+      }
+
+  for (pg = 0; pg < PAGE_CNT; pg++)
+    for (ofs = 0; ofs < PAGE_SIZE; ofs++)
+      if (buf[pg * PAGE_SIZE + ofs] != pattern (key, pg, PASS_CNT - 1))
+        fail ("byte %d of page %d is wrong at the end", ofs, pg);
+  return key;
+}
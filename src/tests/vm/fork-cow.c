@@ -0,0 +1,52 @@
+/* Forks a child that checks it sees the parent's memory, then
+   overwrites it.  The parent's copy must be unaffected. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define SIZE (64 * 1024)
+
+static char buf[SIZE];
+
+/* Checks that every byte of buf is VALUE. */
+static void
+verify (char value)
+{
+  size_t i;
+
+  for (i = 0; i < SIZE; i++)
+    if (buf[i] != value)
+      fail ("byte %zu is %#x instead of %#x", i, buf[i], value);
+}
+
+void
+test_main (void)
+{
+  pid_t pid;
+  int status;
+
+  msg ("initialize");
+  memset (buf, 0x5a, sizeof buf);
+
+  pid = fork ();
+  if (pid == 0)
+    {
+      msg ("child: verify parent's data");
+      verify (0x5a);
+      msg ("child: overwrite data");
+      memset (buf, 0xa5, sizeof buf);
+      verify (0xa5);
+      exit (81);
+    }
+  if (pid == PID_ERROR)
+    fail ("fork() failed");
+
+  status = wait (pid);
+  if (status != 81)
+    fail ("wait() returned %d instead of 81", status);
+  msg ("parent: child exited");
+  msg ("parent: verify data unchanged");
+  verify (0x5a);
+}
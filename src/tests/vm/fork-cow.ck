@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(fork-cow) begin
+(fork-cow) initialize
+(fork-cow) child: verify parent's data
+(fork-cow) child: overwrite data
+fork-cow: exit(81)
+(fork-cow) parent: child exited
+(fork-cow) parent: verify data unchanged
+(fork-cow) end
+fork-cow: exit(0)
+EOF
+pass;
@@ -0,0 +1,35 @@
+/* Forks a child that reads "sample.txt" through a file descriptor
+   opened by the parent, which the child must inherit. */
+
+#include <syscall.h>
+#include "tests/vm/sample.inc"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void)
+{
+  char buf[sizeof sample];
+  int handle, byte_cnt;
+  pid_t pid;
+
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+
+  pid = fork ();
+  if (pid == 0)
+    {
+      byte_cnt = read (handle, buf, sizeof sample - 1);
+      if (byte_cnt != sizeof sample - 1)
+        fail ("read() returned %d instead of %zu",
+              byte_cnt, sizeof sample - 1);
+      compare_bytes (buf, sample, sizeof sample - 1, 0, "sample.txt");
+      msg ("child: read inherited fd");
+      exit (83);
+    }
+  if (pid == PID_ERROR)
+    fail ("fork() failed");
+
+  if (wait (pid) != 83)
+    fail ("wrong exit status from child");
+  msg ("parent: child exited");
+}
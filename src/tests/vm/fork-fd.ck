@@ -0,0 +1,14 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(fork-fd) begin
+(fork-fd) open "sample.txt"
+(fork-fd) child: read inherited fd
+fork-fd: exit(83)
+(fork-fd) parent: child exited
+(fork-fd) end
+fork-fd: exit(0)
+EOF
+pass;
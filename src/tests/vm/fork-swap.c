@@ -0,0 +1,64 @@
+/* Fills 2 MB of memory, more than fits in memory, and forks a
+   child that verifies and then rewrites all of it, so that pages
+   shared copy-on-write are swapped out and in while shared, and
+   copied while under memory pressure.  The parent's copy must be
+   unaffected. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/arc4.h"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define SIZE (2 * 1024 * 1024)
+
+static char buf[SIZE];
+
+/* Checks that every byte of buf is VALUE. */
+static void
+verify (char value)
+{
+  size_t i;
+
+  for (i = 0; i < SIZE; i++)
+    if (buf[i] != value)
+      fail ("byte %zu is %#x instead of %#x", i, buf[i], value);
+}
+
+void
+test_main (void)
+{
+  struct arc4 arc4;
+  pid_t pid;
+  int status;
+
+  msg ("initialize");
+  memset (buf, 0x5a, sizeof buf);
+
+  pid = fork ();
+  if (pid == 0)
+    {
+      msg ("child: read pass");
+      verify (0x5a);
+
+      /* Encrypt, then decrypt, every byte. */
+      msg ("child: read/modify/write passes");
+      arc4_init (&arc4, "foobar", 6);
+      arc4_crypt (&arc4, buf, SIZE);
+      arc4_init (&arc4, "foobar", 6);
+      arc4_crypt (&arc4, buf, SIZE);
+      verify (0x5a);
+      memset (buf, 0xa5, sizeof buf);
+      verify (0xa5);
+      exit (82);
+    }
+  if (pid == PID_ERROR)
+    fail ("fork() failed");
+
+  status = wait (pid);
+  if (status != 82)
+    fail ("wait() returned %d instead of 82", status);
+  msg ("parent: child exited");
+  msg ("parent: read pass");
+  verify (0x5a);
+}
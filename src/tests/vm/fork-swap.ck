@@ -0,0 +1,16 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected ([<<'EOF']);
+(fork-swap) begin
+(fork-swap) initialize
+(fork-swap) child: read pass
+(fork-swap) child: read/modify/write passes
+fork-swap: exit(82)
+(fork-swap) parent: child exited
+(fork-swap) parent: read pass
+(fork-swap) end
+fork-swap: exit(0)
+EOF
+pass;
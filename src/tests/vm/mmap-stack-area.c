@@ -0,0 +1,16 @@
+/* Verifies that mapping anywhere in the area reserved for stack
+   growth is disallowed, even well below the current stack. */
+
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void) 
+{
+  int handle;
+  
+  CHECK ((handle = open ("sample.txt")) > 1, "open \"sample.txt\"");
+  CHECK (mmap (handle, (void *) 0xbfc00000) == MAP_FAILED,
+         "try to mmap 4 MB below top of stack");
+}
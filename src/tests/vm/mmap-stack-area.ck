@@ -0,0 +1,11 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(mmap-stack-area) begin
+(mmap-stack-area) open "sample.txt"
+(mmap-stack-area) try to mmap 4 MB below top of stack
+(mmap-stack-area) end
+EOF
+pass;
@@ -0,0 +1,116 @@
+/* Checks pages brought in without a fault of their own.
+
+   First maps a file and reads its first two pages, which looks
+   like a sequential scan and so reads in the pages after them,
+   then writes to two of those pages before touching them
+   otherwise.  The writes must reach the file when it is unmapped.
+
+   Then fills 2 MB of memory, which pushes most of it to swap, and
+   visits its pages in a scattered order, checking each one and
+   rewriting some.  Pages read in alongside a faulting neighbour
+   must hold their own contents, and the rewritten ones must not
+   lose their new contents when they are evicted again. */
+
+#include <string.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define PAGE_SIZE 4096
+#define FILE_PAGES 12
+#define SIZE (2 * 1024 * 1024)
+#define PAGE_CNT (SIZE / PAGE_SIZE)
+
+#define ACTUAL ((char *) 0x10000000)
+
+static char page[PAGE_SIZE];
+static char buf[SIZE];
+
+/* Returns the byte expected at offset OFS in page I of the
+   file. */
+static char
+file_byte (int i, int ofs) 
+{
+  return ofs == 100 && (i == 4 || i == 5) ? 'X' : 'a' + i;
+}
+
+/* Returns the byte expected in page I of BUF, depending on
+   whether the page has been REWRITTEN. */
+static char
+buf_byte (int i, bool rewritten) 
+{
+  return rewritten ? (char) (i * 3 + 1) : (char) i;
+}
+
+void
+test_main (void) 
+{
+  int handle, i, ofs;
+  mapid_t map;
+
+  CHECK (create ("data", FILE_PAGES * PAGE_SIZE), "create \"data\"");
+  CHECK ((handle = open ("data")) > 1, "open \"data\"");
+  for (i = 0; i < FILE_PAGES; i++)
+    {
+      memset (page, 'a' + i, PAGE_SIZE);
+      if (write (handle, page, PAGE_SIZE) != PAGE_SIZE)
+        fail ("write \"data\" page %d", i);
+    }
+  CHECK ((map = mmap (handle, ACTUAL)) != MAP_FAILED, "mmap \"data\"");
+
+  msg ("read pages 0 and 1, write pages 4 and 5");
+  for (i = 0; i < 2; i++)
+    for (ofs = 0; ofs < PAGE_SIZE; ofs++)
+      if (ACTUAL[i * PAGE_SIZE + ofs] != 'a' + i)
+        fail ("byte %d of page %d is wrong", ofs, i);
+  ACTUAL[4 * PAGE_SIZE + 100] = 'X';
+  ACTUAL[5 * PAGE_SIZE + 100] = 'X';
+
+  msg ("check mapping");
+  for (i = 0; i < FILE_PAGES; i++)
+    for (ofs = 0; ofs < PAGE_SIZE; ofs++)
+      if (ACTUAL[i * PAGE_SIZE + ofs] != file_byte (i, ofs))
+        fail ("byte %d of mapped page %d is wrong", ofs, i);
+  munmap (map);
+
+  msg ("check file");
+  seek (handle, 0);
+  for (i = 0; i < FILE_PAGES; i++)
+    {
+      if (read (handle, page, PAGE_SIZE) != PAGE_SIZE)
+        fail ("read \"data\" page %d", i);
+      for (ofs = 0; ofs < PAGE_SIZE; ofs++)
+        if (page[ofs] != file_byte (i, ofs))
+          fail ("byte %d of page %d in file is wrong", ofs, i);
+    }
+  close (handle);
+
+  msg ("fill memory");
+  for (i = 0; i < PAGE_CNT; i++)
+    memset (buf + i * PAGE_SIZE, buf_byte (i, false), PAGE_SIZE);
+
+  /* PAGE_CNT is a power of 2, so odd strides visit every page. */
+  msg ("check in scattered order, rewriting every third page");
+  for (i = 0; i < PAGE_CNT; i++)
+    {
+      int pg = i * 7 % PAGE_CNT;
+      char *p = buf + pg * PAGE_SIZE;
+
+      for (ofs = 0; ofs < PAGE_SIZE; ofs++)
+        if (p[ofs] != buf_byte (pg, false))
+          fail ("byte %d of page %d is wrong", ofs, pg);
+      if (pg % 3 == 0)
+        memset (p, buf_byte (pg, true), PAGE_SIZE);
+    }
+
+  msg ("check again in another order");
+  for (i = 0; i < PAGE_CNT; i++)
+    {
+      int pg = i * 13 % PAGE_CNT;
+      char *p = buf + pg * PAGE_SIZE;
+
+      for (ofs = 0; ofs < PAGE_SIZE; ofs++)
+        if (p[ofs] != buf_byte (pg, pg % 3 == 0))
+          fail ("byte %d of page %d is wrong after rewrite", ofs, pg);
+    }
+}
@@ -0,0 +1,18 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(page-around) begin
+(page-around) create "data"
+(page-around) open "data"
+(page-around) mmap "data"
+(page-around) read pages 0 and 1, write pages 4 and 5
+(page-around) check mapping
+(page-around) check file
+(page-around) fill memory
+(page-around) check in scattered order, rewriting every third page
+(page-around) check again in another order
+(page-around) end
+EOF
+pass;
@@ -0,0 +1,48 @@
+/* Fills 2 MB of memory with random data, which does not compress
+   and so goes to the swap device, then checks each page against
+   its checksum, first in order, which benefits from swap
+   read-ahead, then in reverse order, which does not. */
+
+#include <string.h>
+#include "tests/arc4.h"
+#include "tests/cksum.h"
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define SIZE (2 * 1024 * 1024)
+#define PAGE_SIZE 4096
+#define PAGE_CNT (SIZE / PAGE_SIZE)
+
+static char buf[SIZE];
+static unsigned long sums[PAGE_CNT];
+
+/* Checks page PAGE of buf against its checksum. */
+static void
+verify_page (size_t page)
+{
+  unsigned long sum = cksum (buf + page * PAGE_SIZE, PAGE_SIZE);
+
+  if (sum != sums[page])
+    fail ("page %zu has checksum %lu instead of %lu", page, sum, sums[page]);
+}
+
+void
+test_main (void)
+{
+  struct arc4 arc4;
+  size_t i;
+
+  msg ("initialize");
+  arc4_init (&arc4, "foobar", 6);
+  arc4_crypt (&arc4, buf, SIZE);
+  for (i = 0; i < PAGE_CNT; i++)
+    sums[i] = cksum (buf + i * PAGE_SIZE, PAGE_SIZE);
+
+  msg ("forward read pass");
+  for (i = 0; i < PAGE_CNT; i++)
+    verify_page (i);
+
+  msg ("backward read pass");
+  for (i = PAGE_CNT; i-- > 0; )
+    verify_page (i);
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(page-cluster) begin
+(page-cluster) initialize
+(page-cluster) forward read pass
+(page-cluster) backward read pass
+(page-cluster) end
+EOF
+pass;
@@ -0,0 +1,47 @@
+/* Fills 2 MB of memory with a different, highly compressible
+   pattern in each page, more than fits in memory, and verifies
+   it twice, so that pages go out to compressed swap and come back
+   intact and in the right places. */
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define SIZE (2 * 1024 * 1024)
+#define PAGE_INTS (4096 / sizeof (unsigned))
+#define CNT (SIZE / sizeof (unsigned))
+
+static unsigned buf[CNT];
+
+/* Returns the word expected at index I. */
+static unsigned
+pattern (size_t i)
+{
+  return (i / PAGE_INTS) * 0x01010101u ^ (i % 4);
+}
+
+/* Checks every word of buf. */
+static void
+verify (void)
+{
+  size_t i;
+
+  for (i = 0; i < CNT; i++)
+    if (buf[i] != pattern (i))
+      fail ("word %zu is %#x instead of %#x", i, buf[i], pattern (i));
+}
+
+void
+test_main (void)
+{
+  size_t i;
+
+  msg ("initialize");
+  for (i = 0; i < CNT; i++)
+    buf[i] = pattern (i);
+
+  msg ("read pass");
+  verify ();
+
+  msg ("read pass");
+  verify ();
+}
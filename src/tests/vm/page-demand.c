@@ -0,0 +1,37 @@
+/* Reads and writes the initialized data of an executable with
+   large read-only and writable data segments, touching their
+   pages out of order, to check that pages loaded on demand hold
+   the right contents. */
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define CNT (256 * 1024 / sizeof (int))
+#define PAGE_INTS (4096 / sizeof (int))
+
+static const int rodata[CNT] = { [0 ... CNT - 1] = 0x12345678 };
+static int data[CNT] = { [0 ... CNT - 1] = 0x5a5a5a5a };
+
+void
+test_main (void)
+{
+  size_t i;
+
+  msg ("read every third page");
+  for (i = 0; i < CNT; i += 3 * PAGE_INTS)
+    if (rodata[i] != 0x12345678 || data[i] != 0x5a5a5a5a)
+      fail ("word %zu is wrong", i);
+
+  msg ("write every other page");
+  for (i = 0; i < CNT; i += 2 * PAGE_INTS)
+    data[i] = i;
+
+  msg ("read pass");
+  for (i = 0; i < CNT; i++)
+    {
+      if (rodata[i] != 0x12345678)
+        fail ("read-only word %zu is wrong", i);
+      if (data[i] != (i % (2 * PAGE_INTS) == 0 ? (int) i : 0x5a5a5a5a))
+        fail ("word %zu is wrong", i);
+    }
+}
@@ -0,0 +1,12 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(page-demand) begin
+(page-demand) read every third page
+(page-demand) write every other page
+(page-demand) read pass
+(page-demand) end
+EOF
+pass;
@@ -0,0 +1,28 @@
+/* Runs 3 child-pageout processes at once, which together need
+   more memory than there is, so that the page-out daemon writes
+   pages to swap while the processes keep using them. */
+
+#include <stdio.h>
+#include <syscall.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define CHILD_CNT 3
+
+void
+test_main (void)
+{
+  pid_t children[CHILD_CNT];
+  char cmd_line[32];
+  int i;
+
+  for (i = 0; i < CHILD_CNT; i++) 
+    {
+      snprintf (cmd_line, sizeof cmd_line, "child-pageout %d", i);
+      CHECK ((children[i] = exec (cmd_line)) != -1,
+             "exec \"%s\"", cmd_line);
+    }
+
+  for (i = 0; i < CHILD_CNT; i++) 
+    CHECK (wait (children[i]) == i, "wait for child %d", i);
+}
@@ -0,0 +1,15 @@
+# -*- perl -*-
+use strict;
+use warnings;
+use tests::tests;
+check_expected (IGNORE_EXIT_CODES => 1, [<<'EOF']);
+(page-pageout) begin
+(page-pageout) exec "child-pageout 0"
+(page-pageout) exec "child-pageout 1"
+(page-pageout) exec "child-pageout 2"
+(page-pageout) wait for child 0
+(page-pageout) wait for child 1
+(page-pageout) wait for child 2
+(page-pageout) end
+EOF
+pass;
@@ -0,0 +1,32 @@
+/* Reads 1 MB of untouched zero-initialized memory, which must all
+   be zero, then writes to every fourth page and checks that only
+   those pages changed. */
+
+#include <string.h>
+#include "tests/lib.h"
+#include "tests/main.h"
+
+#define SIZE (1024 * 1024)
+#define PAGE_SIZE 4096
+
+static char buf[SIZE];
+
+void
+test_main (void)
+{
+  size_t i;
+
+  msg ("read pass");
+  for (i = 0; i < SIZE; i++)
+    if (buf[i] != 0)
+      fail ("byte %zu != 0", i);
+
+  msg ("write every fourth page");
+  for (i = 0; i < SIZE; i += 4 * PAGE_SIZE)
+    memset (buf + i, 0x5a, PAGE_SIZE);
+
+  msg ("read pass");
+  for (i = 0; i < SIZE; i++)
+    if (buf[i] != (i / PAGE_SIZE % 4 == 0 ? 0x5a : 0))
+      fail ("byte %zu is wrong", i);
+}
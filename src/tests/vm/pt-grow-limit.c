@@ -0,0 +1,18 @@
+/* Pushes onto the stack with the stack pointer 9 MB below the top
+   of user memory, beyond the default 8 MB stack limit.  The
+   process must be terminated with -1 exit code. */
+
+#include "tests/lib.h"
+#include "tests/main.h"
+
+void
+test_main (void)
+{
+  asm volatile
+    ("movl %%esp, %%eax;"        /* Save a copy of the stack pointer. */
+     "movl $0xbf700000, %%esp;"  /* 9 MB below PHYS_BASE. */
+     "pushl $0;"                 /* Must fault and kill the process. */
+     "movl %%eax, %%esp"         /* Restore copied stack pointer. */
+     : : : "eax", "memory");
+  fail ("stack grew beyond its limit");
+}
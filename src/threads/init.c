@@ -26,6 +26,7 @@
 #include "userprog/process.h"
 #include "userprog/exception.h"
 #include "userprog/gdt.h"
+#include "userprog/image.h"
 #include "userprog/syscall.h"
 #include "userprog/tss.h"
 #else
@@ -37,6 +38,12 @@
 #include "filesys/filesys.h"
 #include "filesys/fsutil.h"
 #endif
+#ifdef VM
+#include "vm/frame.h"
+#include "vm/page.h"
+#include "vm/swap.h"
+#include "vm/zswap.h"
+#endif
 
 /* Page directory with kernel mappings only. */
 uint32_t *init_page_dir;
@@ -113,6 +120,11 @@ main (void)
 #ifdef USERPROG
   exception_init ();
   syscall_init ();
+  image_init ();
+#endif
+#ifdef VM
+  frame_init ();
+  page_init ();
 #endif
 
   /* Start thread scheduler and enable interrupts. */
@@ -126,6 +138,10 @@ main (void)
   locate_block_devices ();
   filesys_init (format_filesys);
 #endif
+#ifdef VM
+  swap_init ();
+  frame_start_pageout ();
+#endif
 
   printf ("Boot complete.\n");
   
@@ -259,6 +275,12 @@ parse_options (char **argv)
 #ifdef USERPROG
       else if (!strcmp (name, "-ul"))
         user_page_limit = atoi (value);
+#endif
+#ifdef VM
+      else if (!strcmp (name, "-stack"))
+        page_stack_limit = (size_t) atoi (value) * 1024;
+      else if (!strcmp (name, "-zswap"))
+        zswap_size = (size_t) atoi (value) * 1024;
 #endif
       else
         PANIC ("unknown option `%s' (use -h for help)", name);
@@ -381,6 +403,10 @@ usage (void)
           "  -mlfqs             Use multi-level feedback queue scheduler.\n"
 #ifdef USERPROG
           "  -ul=COUNT          Limit user memory to COUNT pages.\n"
+#endif
+#ifdef VM
+          "  -stack=KB          Let user stacks grow to KB kilobytes.\n"
+          "  -zswap=KB          Keep up to KB kilobytes of compressed swap.\n"
 #endif
           );
   shutdown_power_off ();
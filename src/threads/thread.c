@@ -14,6 +14,7 @@
 #include "threads/vaddr.h"
 #ifdef USERPROG
 #include "userprog/process.h"
+#include "userprog/syscall.h"
 #endif
 
 /* Random value for struct thread's `magic' member.
@@ -102,7 +103,11 @@ thread_init (void)
 #ifdef USERPROG
   initial_thread->parent = initial_thread;
   list_init(&initial_thread->children);
-  list_init(&initial_thread->fd_list);
+  initial_thread->fd_table = NULL;
+  initial_thread->fd_table_size = 0;
+  initial_thread->fd_free_hint = FD_FIRST;
+  initial_thread->syscall_stats = NULL;
+  initial_thread->exe_image = NULL;
 #endif
 }
 
@@ -216,7 +221,11 @@ thread_create (const char *name, int priority,
 
 #ifdef USERPROG  //init
   list_init(&t->children);
-  list_init(&t->fd_list);
+  t->fd_table = NULL;
+  t->fd_table_size = 0;
+  t->fd_free_hint = FD_FIRST;
+  t->syscall_stats = NULL;
+  t->exe_image = NULL;
   child_temp = malloc(sizeof(struct child_thread));
   if(t!=initial_thread){
     t->parent = thread_current();
@@ -2,6 +2,7 @@
 #define THREADS_THREAD_H
 
 #include <debug.h>
+#include <hash.h>
 #include <list.h>
 #include <stdint.h>
 
@@ -117,8 +118,18 @@ struct thread
     bool isChildLoaded;
     bool isWaiting;
     struct file* exe_file;
+    struct image *exe_image;            /* Shared pages of exe_file. */
     struct list children;
-    struct list fd_list;
+    struct file_elem **fd_table;        /* Open files, indexed by fd. */
+    int fd_table_size;                  /* Number of slots in fd_table. */
+    int fd_free_hint;                   /* No free fd below this one. */
+    struct syscall_stat *syscall_stats; /* Per-syscall timings, or null. */
+#ifdef VM
+    struct hash pages;                  /* Supplemental page table. */
+    struct list mappings;               /* Memory-mapped files. */
+    int next_mapid;                     /* Next mapping identifier. */
+    void *user_esp;                     /* User esp at syscall entry. */
+#endif
     
     struct list_elem sleepElem;
     int64_t wakeup_time;
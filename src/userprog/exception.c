@@ -1,5 +1,9 @@
 #include "userprog/exception.h"
 #include "userprog/syscall.h"
+#include "userprog/uaccess.h"
+#ifdef VM
+#include "vm/page.h"
+#endif
 #include <inttypes.h>
 #include <stdio.h>
 #include "userprog/gdt.h"
@@ -149,6 +153,28 @@ page_fault (struct intr_frame *f)
   write = (f->error_code & PF_W) != 0;
   user = (f->error_code & PF_U) != 0;
 
+#ifdef VM
+  /* Bring in a page that is part of the process but not yet
+     resident, or a new stack page, whether the process itself or a
+     system call on its behalf touched it.  In the latter case the
+     CPU did not save the user stack pointer, so use the one saved
+     at system call entry. */
+  if (not_present
+      && (page_fault_in (fault_addr, write)
+          || page_grow_stack (fault_addr,
+                              user ? f->esp : thread_current ()->user_esp)))
+    return;
+
+  /* A write to a page shared copy-on-write since fork(). */
+  if (!not_present && write && page_unshare (fault_addr))
+    return;
+#endif
+
+  /* A system call touched a bad user pointer: let the access
+     routine fail instead. */
+  if (!user && uaccess_fixup (f))
+    return;
+
   syscall_exit(-1);
 
   // in case of page fault (REF 3.1.5. Accewssing User Memory)
@@ -0,0 +1,320 @@
+#include "userprog/image.h"
+#include <debug.h>
+#include <hash.h>
+#include <list.h>
+#include <string.h>
+#include "filesys/file.h"
+#include "filesys/inode.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+#include "userprog/pagedir.h"
+
+/* Cache of loaded executables.
+
+   The read-only pages of an executable (its text and rodata) are
+   the same in every process that runs it, so each is loaded once,
+   into a frame that every such process maps read-only.  An image
+   holds its executable's inode open and remembers the inode's
+   write generation, so that pages cached from a file that has
+   since been rewritten are never handed out.  When the last
+   process running an image exits, the image stays cached, pages
+   and all, for the next exec of the same file, until more than
+   IMAGE_IDLE_MAX images are idle or memory runs short. */
+
+/* A cached executable. */
+struct image
+  {
+    struct hash_elem hash_elem;         /* Element in images. */
+    struct list_elem idle_elem;         /* Element in idle_list. */
+    struct inode *inode;                /* Executable, held open. */
+    block_sector_t sector;              /* Inode sector, the key. */
+    unsigned write_gen;                 /* Inode's generation at load. */
+    int users;                          /* Processes running it. */
+    struct hash pages;                  /* Loaded pages, by UPAGE. */
+  };
+
+/* A loaded read-only page of an image. */
+struct image_page
+  {
+    struct hash_elem hash_elem;         /* Element in image's pages. */
+    void *upage;                        /* User virtual address. */
+    off_t ofs;                          /* File offset of contents. */
+    size_t read_bytes;                  /* Bytes read; rest is zero. */
+    void *kpage;                        /* Shared frame. */
+  };
+
+static struct hash images;              /* All cached images. */
+static struct list idle_list;           /* Unused images, oldest first. */
+static struct lock image_lock;          /* Protects all of the above. */
+
+static hash_hash_func image_hash, page_hash;
+static hash_less_func image_less, page_less;
+static void destroy_image (struct image *);
+static bool reclaim_idle (void);
+
+/* Initializes the executable image cache. */
+void
+image_init (void) 
+{
+  hash_init (&images, image_hash, image_less, NULL);
+  list_init (&idle_list);
+  lock_init (&image_lock);
+}
+
+/* Returns the image of executable FILE, creating it if it is not
+   cached, and counts the caller as one of its users.  Returns a
+   null pointer if memory is short or FILE has been changed since
+   it was cached by a process that is still running it. */
+struct image *
+image_open (struct file *file) 
+{
+  struct inode *inode = file_get_inode (file);
+  struct image key, *image = NULL;
+  struct hash_elem *e;
+
+  lock_acquire (&image_lock);
+  key.sector = inode_get_inumber (inode);
+  e = hash_find (&images, &key.hash_elem);
+  if (e != NULL)
+    {
+      image = hash_entry (e, struct image, hash_elem);
+      if (image->write_gen != inode_get_write_gen (image->inode))
+        {
+          /* Stale.  Drop it, unless someone is still using it. */
+          if (image->users > 0)
+            {
+              lock_release (&image_lock);
+              return NULL;
+            }
+          list_remove (&image->idle_elem);
+          destroy_image (image);
+          image = NULL;
+        }
+    }
+
+  if (image == NULL)
+    {
+      image = malloc (sizeof *image);
+      if (image == NULL)
+        {
+          lock_release (&image_lock);
+          return NULL;
+        }
+      image->inode = inode_reopen (inode);
+      image->sector = key.sector;
+      image->write_gen = inode_get_write_gen (inode);
+      image->users = 0;
+      hash_init (&image->pages, page_hash, page_less, NULL);
+      hash_insert (&images, &image->hash_elem);
+    }
+  else if (image->users == 0)
+    list_remove (&image->idle_elem);
+  image->users++;
+  lock_release (&image_lock);
+
+  return image;
+}
+
+/* Looks up the page of IMAGE at UPAGE.  If it is cached, stores
+   its frame into *KPAGE, or a null pointer if the cached page is
+   not the one at offset OFS with READ_BYTES bytes, and returns
+   true.  Returns false if it is not cached.  image_lock must be
+   held. */
+static bool
+find_page (struct image *image, void *upage, off_t ofs, size_t read_bytes,
+           void **kpage) 
+{
+  struct image_page key, *page;
+  struct hash_elem *e;
+
+  key.upage = upage;
+  e = hash_find (&image->pages, &key.hash_elem);
+  if (e == NULL)
+    return false;
+  page = hash_entry (e, struct image_page, hash_elem);
+  *kpage = (page->ofs == ofs && page->read_bytes == read_bytes
+            ? page->kpage : NULL);
+  return true;
+}
+
+/* Like image_get_page(), but returns a null pointer instead of
+   reading the page if it is not already cached. */
+void *
+image_find_page (struct image *image, void *upage, off_t ofs,
+                 size_t read_bytes) 
+{
+  void *kpage = NULL;
+
+  lock_acquire (&image_lock);
+  find_page (image, upage, ofs, read_bytes, &kpage);
+  lock_release (&image_lock);
+  return kpage;
+}
+
+/* Returns the shared frame holding the page of IMAGE mapped at
+   UPAGE, whose first READ_BYTES bytes come from offset OFS of the
+   executable and the rest are zero, reading it in if it is not
+   yet cached.  Returns a null pointer if no frame is available,
+   the read fails, or a different page was cached for UPAGE, in
+   which case the caller should load a private copy. */
+void *
+image_get_page (struct image *image, void *upage, off_t ofs,
+                size_t read_bytes) 
+{
+  struct image_page *page;
+  void *kpage = NULL;
+
+  ASSERT (pg_ofs (upage) == 0);
+  ASSERT (read_bytes <= PGSIZE);
+
+  lock_acquire (&image_lock);
+  if (find_page (image, upage, ofs, read_bytes, &kpage))
+    goto done;
+
+  page = malloc (sizeof *page);
+  if (page == NULL)
+    goto done;
+  do
+    kpage = palloc_get_page (PAL_USER);
+  while (kpage == NULL && reclaim_idle ());
+  if (kpage == NULL
+      || inode_read_at (image->inode, kpage, read_bytes, ofs)
+         != (off_t) read_bytes)
+    {
+      if (kpage != NULL)
+        palloc_free_page (kpage);
+      free (page);
+      kpage = NULL;
+      goto done;
+    }
+  memset ((uint8_t *) kpage + read_bytes, 0, PGSIZE - read_bytes);
+
+  page->upage = upage;
+  page->ofs = ofs;
+  page->read_bytes = read_bytes;
+  page->kpage = kpage;
+  hash_insert (&image->pages, &page->hash_elem);
+
+ done:
+  lock_release (&image_lock);
+  return kpage;
+}
+
+/* Stops the caller from using IMAGE.  Removes its shared pages
+   from page directory PD, if PD is nonnull, so that destroying
+   PD does not free them. */
+void
+image_close (struct image *image, uint32_t *pd) 
+{
+  struct hash_iterator i;
+
+  if (image == NULL)
+    return;
+
+  lock_acquire (&image_lock);
+  if (pd != NULL)
+    {
+      hash_first (&i, &image->pages);
+      while (hash_next (&i))
+        {
+          struct image_page *page
+            = hash_entry (hash_cur (&i), struct image_page, hash_elem);
+          if (pagedir_get_page (pd, page->upage) == page->kpage)
+            pagedir_clear_page (pd, page->upage);
+        }
+    }
+
+  ASSERT (image->users > 0);
+  if (--image->users == 0)
+    {
+      list_push_back (&idle_list, &image->idle_elem);
+      if (list_size (&idle_list) > IMAGE_IDLE_MAX)
+        reclaim_idle ();
+    }
+  lock_release (&image_lock);
+}
+
+/* Frees the least recently used idle image, to make room in the
+   user pool.  Returns true if there was one to free. */
+bool
+image_reclaim (void) 
+{
+  bool success;
+
+  lock_acquire (&image_lock);
+  success = reclaim_idle ();
+  lock_release (&image_lock);
+  return success;
+}
+
+/* Frees the least recently used idle image.  Returns true if
+   there was one.  The image lock must be held. */
+static bool
+reclaim_idle (void) 
+{
+  if (list_empty (&idle_list))
+    return false;
+  destroy_image (list_entry (list_pop_front (&idle_list),
+                             struct image, idle_elem));
+  return true;
+}
+
+/* Frees the page in hash element E. */
+static void
+free_page (struct hash_elem *e, void *aux UNUSED) 
+{
+  struct image_page *page = hash_entry (e, struct image_page, hash_elem);
+  palloc_free_page (page->kpage);
+  free (page);
+}
+
+/* Removes unused IMAGE from the cache and frees it and its pages.
+   The image lock must be held. */
+static void
+destroy_image (struct image *image) 
+{
+  ASSERT (image->users == 0);
+  hash_delete (&images, &image->hash_elem);
+  hash_destroy (&image->pages, free_page);
+  inode_close (image->inode);
+  free (image);
+}
+
+/* Hashes an image by its inode sector. */
+static unsigned
+image_hash (const struct hash_elem *e, void *aux UNUSED) 
+{
+  const struct image *image = hash_entry (e, struct image, hash_elem);
+  return hash_int (image->sector);
+}
+
+/* Orders images by inode sector. */
+static bool
+image_less (const struct hash_elem *a_, const struct hash_elem *b_,
+            void *aux UNUSED) 
+{
+  const struct image *a = hash_entry (a_, struct image, hash_elem);
+  const struct image *b = hash_entry (b_, struct image, hash_elem);
+  return a->sector < b->sector;
+}
+
+/* Hashes an image page by its user address. */
+static unsigned
+page_hash (const struct hash_elem *e, void *aux UNUSED) 
+{
+  const struct image_page *page
+    = hash_entry (e, struct image_page, hash_elem);
+  return hash_bytes (&page->upage, sizeof page->upage);
+}
+
+/* Orders image pages by user address. */
+static bool
+page_less (const struct hash_elem *a_, const struct hash_elem *b_,
+           void *aux UNUSED) 
+{
+  const struct image_page *a = hash_entry (a_, struct image_page, hash_elem);
+  const struct image_page *b = hash_entry (b_, struct image_page, hash_elem);
+  return a->upage < b->upage;
+}
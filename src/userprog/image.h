@@ -0,0 +1,24 @@
+#ifndef USERPROG_IMAGE_H
+#define USERPROG_IMAGE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "filesys/off_t.h"
+
+/* Most unused images kept cached. */
+#define IMAGE_IDLE_MAX 8
+
+struct file;
+struct image;
+
+void image_init (void);
+struct image *image_open (struct file *);
+void *image_get_page (struct image *, void *upage, off_t ofs,
+                      size_t read_bytes);
+void *image_find_page (struct image *, void *upage, off_t ofs,
+                       size_t read_bytes);
+void image_close (struct image *, uint32_t *pd);
+bool image_reclaim (void);
+
+#endif /* userprog/image.h */
@@ -6,6 +6,11 @@
 #include <stdlib.h>
 #include <string.h>
 #include "userprog/gdt.h"
+#include "userprog/image.h"
+#ifdef VM
+#include "vm/mmap.h"
+#include "vm/page.h"
+#endif
 #include "userprog/pagedir.h"
 #include "userprog/tss.h"
 #include "userprog/syscall.h"
@@ -105,6 +110,90 @@ start_process (void *file_name_)
   NOT_REACHED ();
 }
 
+#ifdef VM
+/* What a forked child needs from its parent. */
+struct fork_info
+  {
+    struct thread *parent;              /* Forking process. */
+    struct intr_frame *if_;             /* Parent's system call frame. */
+  };
+
+static thread_func start_fork NO_RETURN;
+
+/* Starts a new process that is a copy of the current one, resuming
+   from system call frame F with a return value of 0.  Writable
+   memory is shared copy-on-write, so little is copied up front.
+   Returns the new process's thread id, or TID_ERROR if it cannot
+   be created. */
+tid_t
+process_fork (struct intr_frame *f)
+{
+  struct thread *curr_thread = thread_current();
+  struct fork_info info;
+  tid_t tid;
+
+  info.parent = curr_thread;
+  info.if_ = f;
+  sema_init(&curr_thread->sema_load, 0);
+  tid = thread_create (curr_thread->name, PRI_DEFAULT, start_fork, &info);
+  if (tid == TID_ERROR)
+    return TID_ERROR;
+
+  // wait until the child has copied what it needs from us
+  sema_down(&curr_thread->sema_load);
+  if(curr_thread->isChildLoaded)
+    curr_thread->isChildLoaded = false;
+  else
+    tid = TID_ERROR;
+  return tid;
+}
+
+/* Gives the current process a copy of PARENT's address space, for
+   fork().  Returns true if successful. */
+static bool
+copy_address_space (struct thread *parent)
+{
+  struct thread *t = thread_current ();
+
+  t->pagedir = pagedir_create ();
+  if (t->pagedir == NULL)
+    return false;
+  page_table_init ();
+  mmap_table_init ();
+  process_activate ();
+
+  t->exe_file = file_reopen (parent->exe_file);
+  if (t->exe_file == NULL)
+    return false;
+  file_deny_write (t->exe_file);
+  t->exe_image = image_open (t->exe_file);
+  return page_table_copy (parent);
+}
+
+/* A thread function that turns a new thread into a copy of the
+   process that forked it and starts it running. */
+static void
+start_fork (void *info_)
+{
+  struct fork_info *info = info_;
+  struct thread *parent = info->parent;
+  struct intr_frame if_ = *info->if_;
+  bool success;
+
+  // the parent is blocked until we sema_up, so it is safe to copy from
+  success = copy_address_space (parent) && copy_all_file (parent);
+  parent->isChildLoaded = success;
+  sema_up(&parent->sema_load);
+  if (!success)
+    syscall_exit(-1);
+
+  /* The child sees fork() return 0. */
+  if_.eax = 0;
+  asm volatile ("movl %0, %%esp; jmp intr_exit" : : "g" (&if_) : "memory");
+  NOT_REACHED ();
+}
+#endif
+
 /* Waits for thread TID to die and returns its exit status.  If
    it was terminated by the kernel (i.e. killed due to an
    exception), returns -1.  If TID is invalid or if it was not a
@@ -175,7 +264,9 @@ process_exit (void)
   // close exe file
   file_close(curr_thread->exe_file);
   // close all file
-  close_all_file(&curr_thread->fd_list);
+  close_all_file();
+  free(curr_thread->syscall_stats);
+  curr_thread->syscall_stats = NULL;
 
   // release(up) wait_sema
   if(curr_thread->parent->isWaiting)
@@ -195,10 +286,18 @@ process_exit (void)
          directory before destroying the process's page
          directory, or our active page directory will be one
          that's been freed (and cleared). */
+#ifdef VM
+      mmap_unmap_all ();
+      page_table_destroy ();
+#endif
       curr_thread->pagedir = NULL;
       pagedir_activate (NULL);
+      image_close (curr_thread->exe_image, pd);
       pagedir_destroy (pd);
     }
+  else
+    image_close (curr_thread->exe_image, NULL);
+  curr_thread->exe_image = NULL;
 }
 
 /* Sets up the CPU for running user code in the current
@@ -282,7 +381,8 @@ struct Elf32_Phdr
 
 static bool setup_stack (void **esp, char *, char**);
 static bool validate_segment (const struct Elf32_Phdr *, struct file *);
-static bool load_segment (struct file *file, off_t ofs, uint8_t *upage,
+static bool load_segment (struct file *file, struct image *image,
+                          off_t ofs, uint8_t *upage,
                           uint32_t read_bytes, uint32_t zero_bytes,
                           bool writable);
 
@@ -305,6 +405,10 @@ load (const char *file_name, void (**eip) (void), void **esp)
   t->pagedir = pagedir_create ();
   if (t->pagedir == NULL) 
     goto done;
+#ifdef VM
+  page_table_init ();
+  mmap_table_init ();
+#endif
   process_activate ();
 
   /* Open executable file. */
@@ -329,6 +433,10 @@ load (const char *file_name, void (**eip) (void), void **esp)
       goto done; 
     }
 
+  /* Share the read-only pages of other processes running the same
+     executable, now that we know it is one. */
+  t->exe_image = image_open (file);
+
   /* Read program headers. */
   file_ofs = ehdr.e_phoff;
   for (i = 0; i < ehdr.e_phnum; i++) 
@@ -378,7 +486,8 @@ load (const char *file_name, void (**eip) (void), void **esp)
                   read_bytes = 0;
                   zero_bytes = ROUND_UP (page_offset + phdr.p_memsz, PGSIZE);
                 }
-              if (!load_segment (file, file_page, (void *) mem_page,
+              if (!load_segment (file, t->exe_image, file_page,
+                                 (void *) mem_page,
                                  read_bytes, zero_bytes, writable))
                 goto done;
             }
@@ -404,13 +513,20 @@ load (const char *file_name, void (**eip) (void), void **esp)
     file_deny_write(file);
   }
   else
-    file_close (file);
+    {
+      /* Give back any image pages already mapped. */
+      image_close (t->exe_image, t->pagedir);
+      t->exe_image = NULL;
+      file_close (file);
+    }
   return success;
 }
 
 /* load() helpers. */
 
+#ifndef VM
 static bool install_page (void *upage, void *kpage, bool writable);
+#endif
 
 /* Checks whether PHDR describes a valid, loadable segment in
    FILE and returns true if so, false otherwise. */
@@ -468,18 +584,23 @@ validate_segment (const struct Elf32_Phdr *phdr, struct file *file)
 
    The pages initialized by this function must be writable by the
    user process if WRITABLE is true, read-only otherwise.
+   Read-only pages are taken from IMAGE, if it is nonnull, and so
+   shared with every other process running the same executable.
+
+   With VM, the pages are only recorded in the supplemental page
+   table here, and each is read in when it is first touched.
 
    Return true if successful, false if a memory allocation error
    or disk read error occurs. */
 static bool
-load_segment (struct file *file, off_t ofs, uint8_t *upage,
-              uint32_t read_bytes, uint32_t zero_bytes, bool writable) 
+load_segment (struct file *file, struct image *image, off_t ofs,
+              uint8_t *upage, uint32_t read_bytes, uint32_t zero_bytes,
+              bool writable) 
 {
   ASSERT ((read_bytes + zero_bytes) % PGSIZE == 0);
   ASSERT (pg_ofs (upage) == 0);
   ASSERT (ofs % PGSIZE == 0);
 
-  file_seek (file, ofs);
   while (read_bytes > 0 || zero_bytes > 0) 
     {
       /* Calculate how to fill this page.
@@ -487,30 +608,51 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
          and zero the final PAGE_ZERO_BYTES bytes. */
       size_t page_read_bytes = read_bytes < PGSIZE ? read_bytes : PGSIZE;
       size_t page_zero_bytes = PGSIZE - page_read_bytes;
-
-      /* Get a page of memory. */
-      uint8_t *kpage = palloc_get_page (PAL_USER);
-      if (kpage == NULL)
+#ifdef VM
+      if (!page_add_file (upage, file, ofs, page_read_bytes, writable, image))
         return false;
+#else
+      uint8_t *kpage = NULL;
 
-      /* Load this page. */
-      if (file_read (file, kpage, page_read_bytes) != (int) page_read_bytes)
+      /* Map the shared copy of a read-only page if we can. */
+      if (!writable && image != NULL)
+        kpage = image_get_page (image, upage, ofs, page_read_bytes);
+      if (kpage != NULL)
         {
-          palloc_free_page (kpage);
-          return false; 
+          if (!install_page (upage, kpage, false))
+            return false;
         }
-      memset (kpage + page_read_bytes, 0, page_zero_bytes);
-
-      /* Add the page to the process's address space. */
-      if (!install_page (upage, kpage, writable)) 
+      else
         {
-          palloc_free_page (kpage);
-          return false; 
+          /* Get a page of memory. */
+          do
+            kpage = palloc_get_page (PAL_USER);
+          while (kpage == NULL && image_reclaim ());
+          if (kpage == NULL)
+            return false;
+
+          /* Load this page. */
+          if (file_read_at (file, kpage, page_read_bytes, ofs)
+              != (int) page_read_bytes)
+            {
+              palloc_free_page (kpage);
+              return false; 
+            }
+          memset (kpage + page_read_bytes, 0, page_zero_bytes);
+
+          /* Add the page to the process's address space. */
+          if (!install_page (upage, kpage, writable)) 
+            {
+              palloc_free_page (kpage);
+              return false; 
+            }
         }
+#endif
 
       /* Advance. */
       read_bytes -= page_read_bytes;
       zero_bytes -= page_zero_bytes;
+      ofs += page_read_bytes;
       upage += PGSIZE;
     }
   return true;
@@ -521,75 +663,87 @@ load_segment (struct file *file, off_t ofs, uint8_t *upage,
 static bool
 setup_stack (void **esp, char *file_name, char **save_ptr) 
 {
+#ifndef VM
   uint8_t *kpage;
+#endif
   bool success = false;
   char *token;
   char **argv_addr;
   int  arg_length, argc=1, i, j;
 
-  kpage = palloc_get_page (PAL_USER | PAL_ZERO);
+#ifdef VM
+  /* The stack is an ordinary zero page, brought in at once because
+     the arguments are about to be written to it. */
+  success = (page_add_zero (((uint8_t *) PHYS_BASE) - PGSIZE, true)
+             && page_fault_in (((uint8_t *) PHYS_BASE) - PGSIZE, true));
+#else
+  do
+    kpage = palloc_get_page (PAL_USER | PAL_ZERO);
+  while (kpage == NULL && image_reclaim ());
   if (kpage != NULL) 
     {
       success = install_page (((uint8_t *) PHYS_BASE) - PGSIZE, kpage, true);
-      if (success){
-        *esp = PHYS_BASE-1;
-
-        // argument parsing
-        arg_length = strlen(file_name) + strlen(*save_ptr) + 1;
-        for (token = strtok_r (NULL, " ", save_ptr);
-             token != NULL;
-             token = strtok_r (NULL, " ", save_ptr), argc++);
-
-        // push args and keep remembering addr of esp
-        argv_addr = malloc(sizeof(char*) * (argc+1));
-        i=(file_name[arg_length] == file_name[arg_length-1])?
-          arg_length-1 : arg_length;
-        for(j=argc; i>=0; i--){
-          if (file_name[i] == ' ')
-            continue;
-          else if (file_name[i] == 0){
-            argv_addr[j--] = (*esp) + 1;
-            memcpy((*esp)--, &file_name[i], sizeof(char));
-          }
-          else
-            memcpy((*esp)--, &file_name[i], sizeof(char));
-        }
-        ASSERT(j==0);
-        argv_addr[j] = *esp + 1;
-
-        // word-alignment
-        while((int)(*esp)%4 != 0)
-          (*esp)--;
-        *esp -= sizeof(char*);
-        memcpy(*esp, &j, sizeof(char*));
-
-        // push the addresses of arguments in stack (argv[])
-        for(i=argc-1;i>=0;i--){
-          *esp -= sizeof(char*);
-          memcpy(*esp, &argv_addr[i], sizeof(char*));
-        }
+      if (!success)
+        palloc_free_page (kpage);
+    }
+#endif
+  if (success){
+    *esp = PHYS_BASE-1;
+
+    // argument parsing
+    arg_length = strlen(file_name) + strlen(*save_ptr) + 1;
+    for (token = strtok_r (NULL, " ", save_ptr);
+         token != NULL;
+         token = strtok_r (NULL, " ", save_ptr), argc++);
+
+    // push args and keep remembering addr of esp
+    argv_addr = malloc(sizeof(char*) * (argc+1));
+    i=(file_name[arg_length] == file_name[arg_length-1])?
+      arg_length-1 : arg_length;
+    for(j=argc; i>=0; i--){
+      if (file_name[i] == ' ')
+        continue;
+      else if (file_name[i] == 0){
+        argv_addr[j--] = (*esp) + 1;
+        memcpy((*esp)--, &file_name[i], sizeof(char));
+      }
+      else
+        memcpy((*esp)--, &file_name[i], sizeof(char));
+    }
+    ASSERT(j==0);
+    argv_addr[j] = *esp + 1;
+
+    // word-alignment
+    while((int)(*esp)%4 != 0)
+      (*esp)--;
+    *esp -= sizeof(char*);
+    memcpy(*esp, &j, sizeof(char*));
+
+    // push the addresses of arguments in stack (argv[])
+    for(i=argc-1;i>=0;i--){
+      *esp -= sizeof(char*);
+      memcpy(*esp, &argv_addr[i], sizeof(char*));
+    }
 
-        // push the address of argv
-        i = *esp;
-        *esp -= sizeof(int);
-        memcpy(*esp, &i, sizeof(int));
+    // push the address of argv
+    i = *esp;
+    *esp -= sizeof(int);
+    memcpy(*esp, &i, sizeof(int));
 
-        // push argc
-        *esp -= sizeof(int);
-        memcpy(*esp, &argc, sizeof(int));
+    // push argc
+    *esp -= sizeof(int);
+    memcpy(*esp, &argc, sizeof(int));
 
-        // push the return address **** what???
-        *esp -= sizeof(void*);
-        memcpy(*esp, &i, sizeof(int));
+    // push the return address **** what???
+    *esp -= sizeof(void*);
+    memcpy(*esp, &i, sizeof(int));
 
-        free(argv_addr);
-      }
-      else
-        palloc_free_page (kpage);
-    }
+    free(argv_addr);
+  }
   return success;
 }
 
+#ifndef VM
 /* Adds a mapping from user virtual address UPAGE to kernel
    virtual address KPAGE to the page table.
    If WRITABLE is true, the user process may modify the page;
@@ -609,3 +763,4 @@ install_page (void *upage, void *kpage, bool writable)
   return (pagedir_get_page (t->pagedir, upage) == NULL
           && pagedir_set_page (t->pagedir, upage, kpage, writable));
 }
+#endif
@@ -10,12 +10,15 @@ struct file_elem
 	int fd;
 	struct file* this_file;
 	struct dir* this_dir;
-	struct list_elem elem;
 };
 
 tid_t process_execute (const char *file_name);
 int process_wait (tid_t);
 void process_exit (void);
 void process_activate (void);
+#ifdef VM
+struct intr_frame;
+tid_t process_fork (struct intr_frame *);
+#endif
 
 #endif /* userprog/process.h */
@@ -1,9 +1,12 @@
 #include "userprog/syscall.h"
 #include "userprog/process.h"
 #include "userprog/pagedir.h"
+#include "userprog/uaccess.h"
 #include <stdio.h>
+#include <string.h>
 #include <syscall-nr.h>
 #include "threads/interrupt.h"
+#include "threads/palloc.h"
 #include "threads/thread.h"
 #include "threads/synch.h"
 #include "threads/vaddr.h"
@@ -11,96 +14,341 @@
 #include "filesys/filesys.h"
 #include "filesys/directory.h"
 #include "filesys/inode.h"
+#include "devices/input.h"
 #include "devices/shutdown.h"
+#ifdef VM
+#include "vm/mmap.h"
+#endif
 
 #define ASSERT_EXIT( COND ) { if(!(COND)) syscall_exit(-1); }
 
 static void syscall_handler (struct intr_frame *);
-
-static struct lock file_lock;
+static void syscall_dispatch (struct intr_frame *, uint32_t nr);
 
 void
 syscall_init (void) 
 {
-  lock_init(&file_lock);
   intr_register_int (0x30, 3, INTR_ON, syscall_handler, "syscall");
 }
 
+/* Number of argument words taken by each system call. */
+static const int syscall_argc[] =
+  {
+    [SYS_HALT] = 0, [SYS_EXIT] = 1, [SYS_EXEC] = 1, [SYS_WAIT] = 1,
+    [SYS_CREATE] = 2, [SYS_REMOVE] = 1, [SYS_OPEN] = 1,
+    [SYS_FILESIZE] = 1, [SYS_READ] = 3, [SYS_WRITE] = 3,
+    [SYS_SEEK] = 2, [SYS_TELL] = 1, [SYS_CLOSE] = 1,
+    [SYS_MMAP] = 2, [SYS_MUNMAP] = 1,
+    [SYS_CHDIR] = 1, [SYS_MKDIR] = 1, [SYS_READDIR] = 2,
+    [SYS_ISDIR] = 1, [SYS_INUMBER] = 1,
+    [SYS_FTRUNCATE] = 2, [SYS_FALLOCATE] = 3, [SYS_READDIRPLUS] = 3,
+    [SYS_PREAD] = 4, [SYS_PWRITE] = 4, [SYS_READV] = 3, [SYS_WRITEV] = 3,
+    [SYS_RING_ENTER] = 2, [SYS_COPY_FILE_RANGE] = 3, [SYS_TTYMODE] = 1,
+    [SYS_STATS] = 3, [SYS_FORK] = 0,
+  };
+
+/* Number of system calls. */
+#define SYSCALL_CNT ((int) (sizeof syscall_argc / sizeof *syscall_argc))
+
+/* System call names, for syscall_print_stats(). */
+static const char* const syscall_name[SYSCALL_CNT] =
+  {
+    [SYS_HALT] = "halt", [SYS_EXIT] = "exit", [SYS_EXEC] = "exec",
+    [SYS_WAIT] = "wait", [SYS_CREATE] = "create", [SYS_REMOVE] = "remove",
+    [SYS_OPEN] = "open", [SYS_FILESIZE] = "filesize", [SYS_READ] = "read",
+    [SYS_WRITE] = "write", [SYS_SEEK] = "seek", [SYS_TELL] = "tell",
+    [SYS_CLOSE] = "close", [SYS_MMAP] = "mmap", [SYS_MUNMAP] = "munmap",
+    [SYS_CHDIR] = "chdir", [SYS_MKDIR] = "mkdir", [SYS_READDIR] = "readdir",
+    [SYS_ISDIR] = "isdir", [SYS_INUMBER] = "inumber",
+    [SYS_FTRUNCATE] = "ftruncate", [SYS_FALLOCATE] = "fallocate",
+    [SYS_READDIRPLUS] = "readdirplus", [SYS_PREAD] = "pread",
+    [SYS_PWRITE] = "pwrite", [SYS_READV] = "readv", [SYS_WRITEV] = "writev",
+    [SYS_RING_ENTER] = "ring_enter",
+    [SYS_COPY_FILE_RANGE] = "copy_file_range", [SYS_TTYMODE] = "ttymode",
+    [SYS_STATS] = "stats", [SYS_FORK] = "fork",
+  };
+
+/* Statistics for all processes together. */
+static struct syscall_stat global_stats[SYSCALL_CNT];
+
+/* Returns the CPU's time-stamp counter. */
+static inline uint64_t
+rdtsc(void)
+{
+	uint64_t tsc;
+	asm volatile ("rdtsc" : "=A" (tsc));
+	return tsc;
+}
+
+/* Adds one call taking CYCLES cycles to STAT. */
+static void
+add_stat(struct syscall_stat* stat, uint64_t cycles)
+{
+	int bucket = 0;
+
+	while(bucket < STAT_HIST_CNT - 1 && (cycles >> (bucket + 1)) != 0)
+		bucket++;
+	stat->cnt++;
+	stat->cycles += cycles;
+	stat->hist[bucket]++;
+}
+
+/* Records a call to system call NR that took CYCLES cycles, both
+   globally and for the current process.  The process's table is
+   allocated on its first system call; if that fails, only the
+   global statistics are kept. */
+static void
+record_syscall(uint32_t nr, uint64_t cycles)
+{
+	struct thread* t = thread_current();
+	enum intr_level old_level;
+
+	if(t->syscall_stats == NULL)
+		t->syscall_stats = calloc(SYSCALL_CNT, sizeof *t->syscall_stats);
+
+	old_level = intr_disable();
+	add_stat(&global_stats[nr], cycles);
+	intr_set_level(old_level);
+	if(t->syscall_stats != NULL)
+		add_stat(&t->syscall_stats[nr], cycles);
+}
+
+/* Handles a system call, timing it for the statistics.  Calls
+   that do not return, such as exit, are not counted. */
 static void
-syscall_handler (struct intr_frame *f UNUSED) 
+syscall_handler (struct intr_frame *f) 
 {
-  // is esp valid?
-  if(f->esp >= 0xc0000000 || f->esp <0x08048000 ||
-  	 (f->esp >= 0xbffffffc && *(int*)(f->esp) != SYS_HALT) )
-  	syscall_exit(-1);
+  uint64_t start = rdtsc();
+  uint32_t nr;
+
+#ifdef VM
+  // page faults in the kernel need this for stack growth
+  thread_current()->user_esp = f->esp;
+#endif
+  ASSERT_EXIT(copy_from_user(&nr, f->esp, sizeof nr));
+  if(nr >= SYSCALL_CNT)
+    return;
+  syscall_dispatch(f, nr);
+  record_syscall(nr, rdtsc() - start);
+}
+
+/* Carries out system call NR for F. */
+static void
+syscall_dispatch (struct intr_frame *f, uint32_t nr)
+{
+  uint32_t arg[4];
+
+  // fetch all of the arguments in one copy
+  ASSERT_EXIT(copy_from_user(arg, (uint32_t*)f->esp + 1,
+                             syscall_argc[nr] * sizeof *arg));
 
   // system call handling
-  switch(*(int*)(f->esp)){
+  switch(nr){
     case SYS_HALT:	
     	shutdown_power_off();
     	break;
     case SYS_EXIT:	
-    	syscall_exit(*((int*)(f->esp)+1));
+    	syscall_exit((int)arg[0]);
     	break;
     case SYS_EXEC:	
-    	f->eax = syscall_exec(*((char**)(f->esp)+1));
+    	f->eax = syscall_exec((char*)arg[0]);
     	break;
     case SYS_WAIT:	
-    	f->eax = syscall_wait(*((int*)(f->esp)+1));
+    	f->eax = syscall_wait((pid_t)arg[0]);
     	break;
     case SYS_CREATE:
-    	f->eax = syscall_create(*((char**)(f->esp)+1), *((unsigned*)(f->esp)+2));
+    	f->eax = syscall_create((const char*)arg[0], (unsigned)arg[1]);
     	break;
     case SYS_REMOVE:
-    	f->eax = syscall_remove(*((char**)(f->esp)+1));
+    	f->eax = syscall_remove((const char*)arg[0]);
     	break;
     case SYS_OPEN:
-    	f->eax = syscall_open(*((char**)(f->esp)+1));
+    	f->eax = syscall_open((const char*)arg[0]);
     	break;
     case SYS_FILESIZE:
-    	f->eax = syscall_filesize(*((char**)(f->esp)+1));
+    	f->eax = syscall_filesize((int)arg[0]);
     	break;
     case SYS_READ:
-    	f->eax = syscall_read(*((int*)(f->esp)+1),
-    						  *((char**)(f->esp)+2),
-    				  		  *((off_t*)(f->esp)+3)); 
+    	f->eax = syscall_read((int)arg[0], (char*)arg[1], (off_t)arg[2]); 
     	break;
     case SYS_WRITE: 
-    	f->eax = syscall_write(*((int*)(f->esp)+1),
-    						   *((char**)(f->esp)+2),
-    				  		   *((off_t*)(f->esp)+3));
+    	f->eax = syscall_write((int)arg[0], (char*)arg[1], (off_t)arg[2]);
     	break;
     case SYS_SEEK:
-    	syscall_seek(*((int*)(f->esp)+1), *((unsigned*)(f->esp)+2)); 
+    	syscall_seek((int)arg[0], (unsigned)arg[1]); 
     	break;
     case SYS_TELL:
-    	f->eax = syscall_tell(*((char**)(f->esp)+1)); 
+    	f->eax = syscall_tell((int)arg[0]); 
      	break;
     case SYS_CLOSE:
-    	syscall_close(*((const char**)(f->esp)+1)); 
+    	syscall_close((int)arg[0]); 
      	break;
+#ifdef VM
+    case SYS_MMAP:
+    	f->eax = syscall_mmap((int)arg[0], (void*)arg[1]);
+    	break;
+    case SYS_MUNMAP:
+    	syscall_munmap((mapid_t)arg[0]);
+    	break;
+    case SYS_FORK:
+    	f->eax = process_fork(f);
+    	break;
+#endif
      case SYS_CHDIR:
-     	f->eax = syscall_chdir(*((char**)(f->esp)+1));
+     	f->eax = syscall_chdir((const char*)arg[0]);
      	break;
      case SYS_MKDIR:
-     	f->eax = syscall_mkdir(*((char**)(f->esp)+1));
+     	f->eax = syscall_mkdir((const char*)arg[0]);
      	break;
     case SYS_READDIR:
-    	f->eax = syscall_readdir(*((char**)(f->esp)+1),*((int*)(f->esp)+2));
+    	f->eax = syscall_readdir((int)arg[0], (char*)arg[1]);
     	break;
     case SYS_ISDIR:
-    	f->eax = syscall_isdir(*((int*)(f->esp)+1));
+    	f->eax = syscall_isdir((int)arg[0]);
     	break;
     case SYS_INUMBER:
-    	f->eax = syscall_inumber(*((int*)(f->esp)+1));
+    	f->eax = syscall_inumber((int)arg[0]);
+    	break;
+    case SYS_FTRUNCATE:
+    	f->eax = syscall_ftruncate((int)arg[0], (off_t)arg[1]);
+    	break;
+    case SYS_FALLOCATE:
+    	f->eax = syscall_fallocate((int)arg[0], (off_t)arg[1], (off_t)arg[2]);
+    	break;
+    case SYS_READDIRPLUS:
+    	f->eax = syscall_readdirplus((int)arg[0],
+    								 (struct readdir_entry*)arg[1],
+    								 (unsigned)arg[2]);
+    	break;
+    case SYS_PREAD:
+    	f->eax = syscall_pread((int)arg[0], (char*)arg[1],
+    						   (off_t)arg[2], (off_t)arg[3]);
+    	break;
+    case SYS_PWRITE:
+    	f->eax = syscall_pwrite((int)arg[0], (char*)arg[1],
+    							(off_t)arg[2], (off_t)arg[3]);
+    	break;
+    case SYS_READV:
+    	f->eax = syscall_readv((int)arg[0], (const struct iovec*)arg[1],
+    						   (int)arg[2]);
+    	break;
+    case SYS_WRITEV:
+    	f->eax = syscall_writev((int)arg[0], (const struct iovec*)arg[1],
+    							(int)arg[2]);
+    	break;
+    case SYS_RING_ENTER:
+    	f->eax = syscall_ring_enter((struct ring*)arg[0], (unsigned)arg[1]);
+    	break;
+    case SYS_COPY_FILE_RANGE:
+    	f->eax = syscall_copy_file_range((int)arg[0], (int)arg[1], (off_t)arg[2]);
+    	break;
+    case SYS_TTYMODE:
+    	f->eax = syscall_ttymode((int)arg[0]);
+    	break;
+    case SYS_STATS:
+    	f->eax = syscall_stats((struct syscall_stat*)arg[0], (unsigned)arg[1],
+    						   (bool)arg[2]);
     	break;
     default: break;
   }
 }
 
+/* Copies the user string USTR into a newly allocated page, which
+   the caller must free with palloc_free_page().  Kills the
+   process if USTR is a bad pointer or does not fit in a page. */
+static char*
+copy_in_string(const char* ustr)
+{
+	char* kstr = palloc_get_page(0);
+
+	if(kstr == NULL)
+		syscall_exit(-1);
+	if(strncpy_from_user(kstr, ustr, PGSIZE) < 0){
+		palloc_free_page(kstr);
+		syscall_exit(-1);
+	}
+	return kstr;
+}
+
+/* Reads up to SIZE bytes into user buffer UBUF from FILE, or from
+   the keyboard if FILE is null, in which case only the keys
+   already typed (in canonical mode, one line) are returned.  Reads at OFFSET, or at the file
+   position if OFFSET is negative.  Data passes through a kernel
+   page one page at a time, so a bad UBUF is caught by the copy
+   rather than checked up front.  Returns the number of bytes
+   read, or -1 if out of memory. */
+static off_t
+read_to_user(struct file* file, void* ubuf, off_t size, off_t offset)
+{
+	uint8_t* kbuf;
+	off_t done = 0, chunk, n;
+
+	if(size <= 0)
+		return 0;
+	kbuf = palloc_get_page(0);
+	if(kbuf == NULL)
+		return -1;
+	while(done < size){
+		chunk = size - done < PGSIZE ? size - done : PGSIZE;
+		if(file == NULL)
+			n = input_read(kbuf, chunk);
+		else if(offset < 0)
+			n = file_read(file, kbuf, chunk);
+		else
+			n = file_read_at(file, kbuf, chunk, offset + done);
+		if(n > 0 && !copy_to_user((uint8_t*)ubuf + done, kbuf, n)){
+			palloc_free_page(kbuf);
+			syscall_exit(-1);
+		}
+		done += n;
+		if(n < chunk)
+			break;
+	}
+	palloc_free_page(kbuf);
+	return done;
+}
+
+/* Writes up to SIZE bytes from user buffer UBUF to FILE, or to
+   the console if FILE is null, in the same way as
+   read_to_user(). */
+static off_t
+write_from_user(struct file* file, const void* ubuf, off_t size, off_t offset)
+{
+	uint8_t* kbuf;
+	off_t done = 0, chunk, n;
+
+	if(size <= 0)
+		return 0;
+	kbuf = palloc_get_page(0);
+	if(kbuf == NULL)
+		return -1;
+	while(done < size){
+		chunk = size - done < PGSIZE ? size - done : PGSIZE;
+		if(!copy_from_user(kbuf, (const uint8_t*)ubuf + done, chunk)){
+			palloc_free_page(kbuf);
+			syscall_exit(-1);
+		}
+		if(file == NULL){
+			putbuf((const char*)kbuf, chunk);
+			n = chunk;
+		}
+		else if(offset < 0)
+			n = file_write(file, kbuf, chunk);
+		else
+			n = file_write_at(file, kbuf, chunk, offset + done);
+		done += n;
+		if(n < chunk)
+			break;
+	}
+	palloc_free_page(kbuf);
+	return done;
+}
+
 bool syscall_chdir(const char* path){
 	struct thread *t = thread_current();
-	struct dir *dir = dir_chdir(path);
+	char *kpath = copy_in_string(path);
+	struct dir *dir = dir_chdir(kpath);
+	palloc_free_page(kpath);
 	if(dir){
 		dir_close(t->dir_current);
 		t->dir_current = dir;
@@ -110,29 +358,77 @@ bool syscall_chdir(const char* path){
 		return false;
 }
 bool syscall_mkdir(const char* dir){
-	return filesys_create(dir,0,true);	//TODO filesys create
+	char *kdir = copy_in_string(dir);
+	bool success = filesys_create(kdir,0,true);	//TODO filesys create
+	palloc_free_page(kdir);
+	return success;
 }
 bool syscall_readdir(int fd, char *name){
-	ASSERT_EXIT(get_file_elem(fd)->this_file);
 	struct file_elem* felem = get_file_elem(fd);
-	if(!felem || felem->this_dir == NULL)
+	char kname[READDIR_MAX_LEN + 1];
+	ASSERT_EXIT(felem && felem->this_file);
+	if(felem->this_dir == NULL)
+		return false;
+	if(!dir_readdir(felem->this_dir, kname))
 		return false;
-	else 
-		return dir_readdir(felem->this_dir, name);
+	ASSERT_EXIT(copy_to_user(name, kname, strlen(kname) + 1));
+	return true;
 }
 bool syscall_isdir(int fd){
-	ASSERT_EXIT(get_file_elem(fd)->this_file);
-	return get_file_elem(fd)->this_dir != NULL;
+	struct file_elem* felem = get_file_elem(fd);
+	ASSERT_EXIT(felem && felem->this_file);
+	return felem->this_dir != NULL;
 }
 int syscall_inumber(int fd){
-	ASSERT_EXIT(get_file_elem(fd)->this_file);
 	struct file_elem* felem = get_file_elem(fd);
+	ASSERT_EXIT(felem && felem->this_file);
 	if(felem->this_dir)
 		return inode_get_inumber(dir_get_inode(felem->this_dir));
 	else
 		return inode_get_inumber(file_get_inode(felem->this_file));
 }
 
+bool syscall_ftruncate(int fd, off_t length){
+	struct file_elem* felem = get_file_elem(fd);
+	ASSERT_EXIT(felem && felem->this_file);
+	if(felem->this_dir || length < 0)
+		return false;
+	return file_truncate(felem->this_file, length);
+}
+bool syscall_fallocate(int fd, off_t offset, off_t length){
+	struct file_elem* felem = get_file_elem(fd);
+	ASSERT_EXIT(felem && felem->this_file);
+	// reject negative ranges and ranges that overflow off_t
+	if(felem->this_dir || offset < 0 || length <= 0 || length > INT32_MAX - offset)
+		return false;
+	return file_allocate(felem->this_file, offset, length);
+}
+int syscall_readdirplus(int fd, struct readdir_entry *entries, unsigned cnt){
+	struct file_elem* felem = get_file_elem(fd);
+	struct readdir_entry e;
+	struct inode* inode;
+	block_sector_t sector;
+	unsigned i;
+
+	ASSERT_EXIT(felem && felem->this_file);
+	if(felem->this_dir == NULL)
+		return -1;
+
+	// fill as many entries as fit, one inode read each
+	for(i=0;i<cnt;i++){
+		memset(&e, 0, sizeof e);
+		if(!dir_readdir_sector(felem->this_dir, e.name, &sector))
+			break;
+		inode = inode_open(sector);
+		e.inumber = sector;
+		e.isdir = inode != NULL && inode_get_parent(inode) != (block_sector_t) -1;
+		e.length = inode != NULL ? inode_length(inode) : 0;
+		inode_close(inode);
+		ASSERT_EXIT(copy_to_user(&entries[i], &e, sizeof e));
+	}
+	return i;
+}
+
 
 void 
 syscall_exit(int status)
@@ -141,7 +437,7 @@ syscall_exit(int status)
 	struct list_elem* iter;
 
 	// TODO: close files opened
-	//close_all_file(&curr_thread->fd_list);
+	//close_all_file();
 
 	// set exit code
 	for(iter = list_begin(&curr_thread->parent->children);
@@ -158,10 +454,10 @@ syscall_exit(int status)
 pid_t
 syscall_exec(char* cmd_str)
 {
-	if(!pagedir_get_page(thread_current()->pagedir, cmd_str))
-		return -1;
-	else
-		return process_execute(cmd_str);
+	char* kcmd = copy_in_string(cmd_str);
+	pid_t pid = process_execute(kcmd);
+	palloc_free_page(kcmd);
+	return pid;
 }
 
 int
@@ -173,15 +469,19 @@ syscall_wait(pid_t pid)
 bool
 syscall_create(const char* name, unsigned size)
 {
-	ASSERT_EXIT(name);
-	return filesys_create(name, size, false);
+	char* kname = copy_in_string(name);
+	bool success = filesys_create(kname, size, false);
+	palloc_free_page(kname);
+	return success;
 }
 
 bool 
 syscall_remove(const char* name)
 {
-	ASSERT_EXIT(name);
-	return filesys_remove(name);
+	char* kname = copy_in_string(name);
+	bool success = filesys_remove(kname);
+	palloc_free_page(kname);
+	return success;
 }
 
 int
@@ -193,16 +493,21 @@ syscall_open(const char* name)
 	struct dir* dir;
 	struct dir* dir_current = thread_current()->dir_current;
 
-	ASSERT_EXIT(name);
+	char* kname = copy_in_string(name);
 	
 	// filesys open
-	open_file = filesys_open(name);
+	open_file = filesys_open(kname);
+	palloc_free_page(kname);
 	if(!open_file)
 		return -1;
 
 	//add file to thread
 	felem = malloc(sizeof(struct file_elem));
-	felem->fd = set_new_fd();
+	if(felem == NULL || set_new_fd(felem) == -1){
+		free(felem);
+		file_close(open_file);
+		return -1;
+	}
 	felem->this_dir = NULL;
 	felem->this_file = open_file;
 
@@ -217,7 +522,6 @@ syscall_open(const char* name)
 			dir = dir_open(file_get_inode(open_file));
 		felem->this_dir = dir;
 	}
-	list_push_back(&thread_current()->fd_list, &felem->elem);
 
 	return felem->fd;
 }
@@ -225,142 +529,472 @@ syscall_open(const char* name)
 int
 syscall_filesize(int fd)
 {
-	struct file* f;
-	if(!(f = get_file_elem(fd)->this_file))
-		return -1;
-	return file_length(f);
+	struct file_elem* felem = get_file_elem(fd);
+	return felem == NULL || felem->this_file == NULL ? -1 : file_length(felem->this_file);
 }
 
 int
 syscall_read(int fd, char* buffer, off_t size)
 {
-	int i;
-	ASSERT_EXIT(is_user_vaddr(buffer) && (buffer>0x08048000));
-	ASSERT_EXIT(fd == STDIN_FILENO || get_file_elem(fd)->this_file);
-	if(fd==STDIN_FILENO){
-		for(i=0;i<size;i++)
-			buffer[i] = input_getc();
-		return i;
-	}
-	return file_read(get_file_elem(fd)->this_file, buffer, size);
+	struct file_elem* felem = get_file_elem(fd);
+	ASSERT_EXIT(fd == STDIN_FILENO || (felem && felem->this_file));
+	if(fd==STDIN_FILENO)
+		return read_to_user(NULL, buffer, size, -1);
+	return read_to_user(felem->this_file, buffer, size, -1);
 }
 
 off_t
 syscall_write(int fd, char* buffer, off_t size)
 {
-	ASSERT_EXIT(is_user_vaddr(buffer) && (buffer>0x08048000));
-	ASSERT_EXIT(fd == STDOUT_FILENO || get_file_elem(fd)->this_file);
-	if(fd==STDOUT_FILENO){
-		putbuf(buffer,size);
-		return size;
+	struct file_elem* felem = get_file_elem(fd);
+	ASSERT_EXIT(fd == STDOUT_FILENO || (felem && felem->this_file));
+	if(fd==STDOUT_FILENO)
+		return write_from_user(NULL, buffer, size, -1);
+	return write_from_user(felem->this_file, buffer, size, -1);
+}
+
+/* Reads at OFFSET without using or moving the file position, so
+   that several readers may share one fd. */
+int
+syscall_pread(int fd, char* buffer, off_t size, off_t offset)
+{
+	struct file_elem* felem = get_file_elem(fd);
+	ASSERT_EXIT(felem && felem->this_file);
+	if(felem->this_dir || offset < 0)
+		return -1;
+	return read_to_user(felem->this_file, buffer, size, offset);
+}
+
+/* Writes at OFFSET without using or moving the file position. */
+off_t
+syscall_pwrite(int fd, char* buffer, off_t size, off_t offset)
+{
+	struct file_elem* felem = get_file_elem(fd);
+	ASSERT_EXIT(felem && felem->this_file);
+	if(felem->this_dir || offset < 0)
+		return -1;
+	return write_from_user(felem->this_file, buffer, size, offset);
+}
+
+/* Copies the CNT-element user iovec array UIOV into a newly
+   allocated kernel array, which the caller must free, and stores
+   the total length of its buffers into *TOTAL.  Kills the process
+   if UIOV is bad or the total overflows.  The buffers themselves
+   are checked as they are copied. */
+static struct iovec*
+copy_in_iovec(const struct iovec* uiov, int cnt, off_t* total)
+{
+	struct iovec* iov;
+	size_t sum = 0;
+	int i;
+
+	ASSERT_EXIT(cnt >= 0 && cnt <= IOV_MAX);
+	iov = malloc(cnt * sizeof *iov + 1);	// never malloc(0), which fails
+	ASSERT_EXIT(iov != NULL);
+	if(!copy_from_user(iov, uiov, cnt * sizeof *iov)){
+		free(iov);
+		syscall_exit(-1);
+	}
+	for(i=0;i<cnt;i++){
+		sum += iov[i].iov_len;
+		if(iov[i].iov_len > INT32_MAX || sum > INT32_MAX){
+			free(iov);
+			syscall_exit(-1);
+		}
 	}
-	return file_write(get_file_elem(fd)->this_file, buffer, size);
+	*total = sum;
+	return iov;
 }
+
+/* Reads into each of the CNT buffers in UIOV in turn, stopping at
+   end of file. */
+int
+syscall_readv(int fd, const struct iovec* uiov, int cnt)
+{
+	struct file_elem* felem = get_file_elem(fd);
+	struct file* file = NULL;
+	struct iovec* iov;
+	off_t total, bytes_read = 0, n;
+	int i;
+
+	ASSERT_EXIT(fd == STDIN_FILENO || (felem && felem->this_file));
+	if(fd != STDIN_FILENO){
+		if(felem->this_dir)
+			return -1;
+		file = felem->this_file;
+	}
+
+	iov = copy_in_iovec(uiov, cnt, &total);
+	for(i=0;i<cnt;i++){
+		n = read_to_user(file, iov[i].iov_base, iov[i].iov_len, -1);
+		if(n < 0)
+			break;
+		bytes_read += n;
+		if(n < (off_t) iov[i].iov_len)
+			break;
+	}
+	free(iov);
+	return bytes_read;
+}
+
+/* Writes each of the CNT buffers in UIOV in turn.  The file is
+   extended once, up front, for the whole write rather than once
+   per buffer.  Returns -1 without writing anything if the write
+   would run past the largest file offset or the file cannot be
+   extended, e.g. because writes to it are denied or the disk is
+   full. */
+int
+syscall_writev(int fd, const struct iovec* uiov, int cnt)
+{
+	struct file_elem* felem = get_file_elem(fd);
+	struct file* file = NULL;
+	struct iovec* iov;
+	off_t total, bytes_written = 0, n;
+	int i;
+
+	ASSERT_EXIT(fd == STDOUT_FILENO || (felem && felem->this_file));
+	if(fd != STDOUT_FILENO){
+		if(felem->this_dir)
+			return -1;
+		file = felem->this_file;
+	}
+
+	iov = copy_in_iovec(uiov, cnt, &total);
+	if(file != NULL && total > 0){
+		if(total > INT32_MAX - file_tell(file)
+		   || !file_allocate(file, file_tell(file), total)){
+			free(iov);
+			return -1;
+		}
+	}
+	for(i=0;i<cnt;i++){
+		n = write_from_user(file, iov[i].iov_base, iov[i].iov_len, -1);
+		if(n < 0)
+			break;
+		bytes_written += n;
+		if(n < (off_t) iov[i].iov_len)
+			break;
+	}
+	free(iov);
+	return bytes_written;
+}
+
+/* Performs the queued operation SQE and returns its result.
+   Unlike the system calls themselves, a bad fd fails just this
+   operation instead of killing the process. */
+static int
+ring_do_sqe(const struct ring_sqe* sqe)
+{
+	struct file_elem* felem = get_file_elem(sqe->fd);
+	struct file* file = NULL;
+
+	switch(sqe->opcode){
+		case RING_OP_NOP:
+			return 0;
+		case RING_OP_OPEN:
+			return syscall_open(sqe->buf);
+		case RING_OP_CLOSE:
+			return sqe->fd >= FD_FIRST && close_file(sqe->fd) ? 0 : -1;
+		case RING_OP_READ:
+		case RING_OP_WRITE:
+			if(sqe->len > INT32_MAX)
+				return -1;
+			if(sqe->fd == (sqe->opcode == RING_OP_READ ? STDIN_FILENO : STDOUT_FILENO)){
+				if(sqe->offset >= 0)
+					return -1;
+			}
+			else if(felem == NULL || felem->this_file == NULL || felem->this_dir)
+				return -1;
+			else
+				file = felem->this_file;
+			if(sqe->opcode == RING_OP_READ)
+				return read_to_user(file, sqe->buf, sqe->len, sqe->offset);
+			return write_from_user(file, sqe->buf, sqe->len, sqe->offset);
+		default:
+			return -1;
+	}
+}
+
+/* Consumes up to TO_SUBMIT queued operations from the rings at
+   URING, posting a completion for each, all in one kernel entry.
+   Stops early if the completion ring fills up.  Returns the number
+   of operations consumed, or -1 if the ring is malformed. */
+int
+syscall_ring_enter(struct ring* uring, unsigned to_submit)
+{
+	struct ring r;
+	struct ring_sqe sqe;
+	struct ring_cqe cqe;
+	unsigned mask, done = 0;
+
+	ASSERT_EXIT(copy_from_user(&r, uring, sizeof r));
+	if(r.entries == 0 || (r.entries & (r.entries - 1)) != 0
+	   || r.sq_tail - r.sq_head > r.entries || r.cq_tail - r.cq_head > r.entries)
+		return -1;
+	mask = r.entries - 1;
+	if(to_submit > r.sq_tail - r.sq_head)
+		to_submit = r.sq_tail - r.sq_head;
+
+	while(done < to_submit && r.cq_tail - r.cq_head < r.entries){
+		ASSERT_EXIT(copy_from_user(&sqe, &r.sqes[r.sq_head & mask], sizeof sqe));
+		r.sq_head++;
+		cqe.user_data = sqe.user_data;
+		cqe.res = ring_do_sqe(&sqe);
+		ASSERT_EXIT(copy_to_user(&r.cqes[r.cq_tail & mask], &cqe, sizeof cqe));
+		r.cq_tail++;
+		done++;
+	}
+
+	// publish the indexes we own only once, at the end
+	ASSERT_EXIT(copy_to_user(&uring->sq_head, &r.sq_head, sizeof r.sq_head));
+	ASSERT_EXIT(copy_to_user(&uring->cq_tail, &r.cq_tail, sizeof r.cq_tail));
+	return done;
+}
+
+/* Copies up to LENGTH bytes from IN_FD to OUT_FD at their current
+   positions without passing the data through user memory. */
+int
+syscall_copy_file_range(int in_fd, int out_fd, off_t length)
+{
+	struct file_elem* in = get_file_elem(in_fd);
+	struct file_elem* out = get_file_elem(out_fd);
+
+	ASSERT_EXIT(in && in->this_file && out && out->this_file);
+	if(in->this_dir || out->this_dir || length < 0)
+		return -1;
+	return file_copy(out->this_file, in->this_file, length);
+}
+
+/* Switches console input to MODE and returns the previous mode,
+   or -1 if MODE is not TTY_RAW or TTY_CANONICAL. */
+int
+syscall_ttymode(int mode)
+{
+	if(mode != TTY_RAW && mode != TTY_CANONICAL)
+		return -1;
+	return input_set_mode(mode == TTY_RAW ? INPUT_RAW : INPUT_CANONICAL)
+	       == INPUT_RAW ? TTY_RAW : TTY_CANONICAL;
+}
+
+/* Copies the statistics of up to CNT system calls, indexed by
+   system call number, into USTATS: those of all processes if
+   GLOBAL, otherwise those of the calling process.  Returns the
+   number copied. */
+int
+syscall_stats(struct syscall_stat* ustats, unsigned cnt, bool global)
+{
+	struct thread* t = thread_current();
+	struct syscall_stat* stats = global ? global_stats : t->syscall_stats;
+	struct syscall_stat* copy;
+	enum intr_level old_level;
+
+	if(cnt > SYSCALL_CNT)
+		cnt = SYSCALL_CNT;
+	if(stats == NULL || cnt == 0)
+		return 0;
+
+	// snapshot first, so that no other process updates it mid-copy
+	copy = malloc(cnt * sizeof *copy);
+	if(copy == NULL)
+		return -1;
+	old_level = intr_disable();
+	memcpy(copy, stats, cnt * sizeof *copy);
+	intr_set_level(old_level);
+	if(!copy_to_user(ustats, copy, cnt * sizeof *copy)){
+		free(copy);
+		syscall_exit(-1);
+	}
+	free(copy);
+	return cnt;
+}
+
+/* Prints the statistics of every system call made since boot,
+   with the nonempty latency buckets of each. */
+void
+syscall_print_stats(void)
+{
+	uint64_t cnt = 0, cycles = 0;
+	int nr, i;
+
+	for(nr = 0; nr < SYSCALL_CNT; nr++){
+		cnt += global_stats[nr].cnt;
+		cycles += global_stats[nr].cycles;
+	}
+	printf("Syscall: %llu calls, %llu cycles\n", cnt, cycles);
+	for(nr = 0; nr < SYSCALL_CNT; nr++){
+		const struct syscall_stat* s = &global_stats[nr];
+		if(s->cnt == 0)
+			continue;
+		printf("  %-16s %8llu calls %12llu cycles %8llu avg  log2:",
+		       syscall_name[nr], s->cnt, s->cycles, s->cycles / s->cnt);
+		for(i = 0; i < STAT_HIST_CNT; i++)
+			if(s->hist[i] != 0)
+				printf(" %d:%u", i, s->hist[i]);
+		printf("\n");
+	}
+}
+
 void
 syscall_seek(int fd, unsigned position)
 {
-	ASSERT_EXIT(get_file_elem(fd)->this_file);
-	return file_seek(get_file_elem(fd)->this_file, position);
+	struct file_elem* felem = get_file_elem(fd);
+	ASSERT_EXIT(felem && felem->this_file);
+	return file_seek(felem->this_file, position);
 }
 
 unsigned
 syscall_tell(int fd)
 {
-	ASSERT_EXIT(get_file_elem(fd)->this_file);
-	return file_tell(get_file_elem(fd)->this_file);
+	struct file_elem* felem = get_file_elem(fd);
+	ASSERT_EXIT(felem && felem->this_file);
+	return file_tell(felem->this_file);
 }
 
 void
 syscall_close(int fd)
 {
-	ASSERT_EXIT(get_file_elem(fd)->this_file);
+	struct file_elem* felem = get_file_elem(fd);
+	ASSERT_EXIT(felem && felem->this_file);
 	if(fd == STDOUT_FILENO || fd == STDIN_FILENO)
 		return;
-	if(syscall_isdir(fd))
-		dir_close(get_file_elem(fd)->this_dir);
-	else
-		ASSERT_EXIT(close_file(fd));
+	ASSERT_EXIT(close_file(fd));
 }
 
+#ifdef VM
+/* Maps the file open as FD into memory at ADDR.  Returns the
+   mapping's identifier, or MAP_FAILED. */
+mapid_t
+syscall_mmap(int fd, void* addr)
+{
+	struct file_elem* felem = get_file_elem(fd);
+
+	if(felem == NULL || felem->this_file == NULL || felem->this_dir != NULL)
+		return MAP_FAILED;
+	return mmap_map(felem->this_file, addr);
+}
+
+/* Unmaps MAPPING, writing back the pages the process modified.
+   An unknown MAPPING is ignored. */
+void
+syscall_munmap(mapid_t mapping)
+{
+	mmap_unmap(mapping);
+}
+#endif
+
 
 struct file_elem*
 get_file_elem(int fd){
 	struct thread* curr_thread = thread_current();
-	struct list_elem* iter;
-	
-	if(list_empty(&curr_thread->fd_list))
-		return NULL;
 
-	for(iter = list_begin(&curr_thread->fd_list);
-		iter != list_end(&curr_thread->fd_list);
-		iter = iter->next)
-		if(list_entry(iter,struct file_elem, elem)->fd == fd)
-			return list_entry(iter,struct file_elem, elem);
-	return NULL;
+	if(fd < 0 || fd >= curr_thread->fd_table_size)
+		return NULL;
+	return curr_thread->fd_table[fd];
 }
 
 bool close_file(int fd)
 {
 	struct thread* curr_thread = thread_current();
-	struct list_elem* iter;
-	struct file_elem* felem;
+	struct file_elem* felem = get_file_elem(fd);
 
-	if(list_empty(&curr_thread->fd_list))
+	if(felem == NULL)
 		return false;
 
-	for(iter = list_begin(&curr_thread->fd_list);
-		iter != list_end(&curr_thread->fd_list);
-		iter = iter->next){
-		felem = list_entry(iter, struct file_elem, elem);
-		if(felem->fd == fd){
-			// TODOOTODOTODOTODOTODOTOOTODOTOD
-			if (felem->this_dir)
-				dir_close(felem->this_dir);
-			else
-				file_close(felem->this_file);
-			list_remove(iter);
-			free(felem);
-			return true;
-		}
-	}
-	return false;
+	if (felem->this_dir)
+		dir_close(felem->this_dir);
+	else
+		file_close(felem->this_file);
+	curr_thread->fd_table[fd] = NULL;
+	if(fd < curr_thread->fd_free_hint)
+		curr_thread->fd_free_hint = fd;
+	free(felem);
+	return true;
 }
 
-// NOT IMPLEMENTED
-void close_all_file(struct list* fd_list)
+/* Gives the current process a copy of PARENT's fd table, each fd
+   open on the same file or directory at the same position.
+   Returns false if out of memory. */
+bool copy_all_file(struct thread* parent)
 {
-	struct list_elem* iter;
-	struct list_elm* next;
+	struct thread* curr_thread = thread_current();
 	struct file_elem* felem;
+	int fd;
 
-	if(list_empty(fd_list))
-		return;
-
-	for(iter = list_begin(fd_list);
-		iter != list_end(fd_list);
-		iter = next){
-		next = iter->next;
-		felem = list_entry(iter, struct file_elem, elem);
-			// TODOOTODOTODOTODOTODOTOOTODOTOD
-		if (felem->this_dir)
-			dir_close(felem->this_dir);
-		else
-			file_close(felem->this_file);
-		list_remove(iter);
-		free(felem);
+	curr_thread->fd_table = calloc(parent->fd_table_size,
+	                               sizeof *curr_thread->fd_table);
+	if(parent->fd_table_size > 0 && curr_thread->fd_table == NULL)
+		return false;
+	curr_thread->fd_table_size = parent->fd_table_size;
+	curr_thread->fd_free_hint = parent->fd_free_hint;
+
+	for(fd = 0; fd < parent->fd_table_size; fd++){
+		struct file_elem* pelem = parent->fd_table[fd];
+		if(pelem == NULL)
+			continue;
+		felem = malloc(sizeof(struct file_elem));
+		if(felem == NULL)
+			return false;
+		felem->fd = fd;
+		felem->this_file = file_reopen(pelem->this_file);
+		felem->this_dir = NULL;
+		if(felem->this_file == NULL){
+			free(felem);
+			return false;
+		}
+		file_seek(felem->this_file, file_tell(pelem->this_file));
+		if(pelem->this_dir)	// shares the file's inode, as in open
+			felem->this_dir = dir_open(file_get_inode(felem->this_file));
+		curr_thread->fd_table[fd] = felem;
 	}
-	list_init(fd_list);
+	return true;
+}
+
+void close_all_file(void)
+{
+	struct thread* curr_thread = thread_current();
+	int fd;
+
+	for(fd = 0; fd < curr_thread->fd_table_size; fd++)
+		close_file(fd);
+	free(curr_thread->fd_table);
+	curr_thread->fd_table = NULL;
+	curr_thread->fd_table_size = 0;
+	curr_thread->fd_free_hint = FD_FIRST;
 }
 
 
+/* Installs FELEM in the lowest free slot of the current thread's
+   fd table, growing the table when FD lies past its end, and
+   returns the new fd.  Returns -1 if out of memory. */
 int
-set_new_fd(void){
-	static int global_fd = 2;
-	int new_fd;
-
-	lock_acquire(&file_lock);
-	new_fd = global_fd++;
-	lock_release(&file_lock);
+set_new_fd(struct file_elem* felem){
+	struct thread* curr_thread = thread_current();
+	struct file_elem** new_table;
+	int fd, old_size, new_size;
+
+	for(fd = curr_thread->fd_free_hint; fd < curr_thread->fd_table_size; fd++)
+		if(curr_thread->fd_table[fd] == NULL)
+			break;
+
+	// no free slot below the end of the table (or no table yet,
+	// in which case FD starts at FD_FIRST): grow it
+	if(fd >= curr_thread->fd_table_size){
+		old_size = curr_thread->fd_table_size;
+		new_size = old_size * 2;
+		if(new_size < fd + 1)
+			new_size = fd + 1;
+		if(new_size < FD_TABLE_MIN_SIZE)
+			new_size = FD_TABLE_MIN_SIZE;
+		new_table = realloc(curr_thread->fd_table, new_size * sizeof *new_table);
+		if(new_table == NULL)
+			return -1;
+		memset(new_table + old_size, 0, (new_size - old_size) * sizeof *new_table);
+		curr_thread->fd_table = new_table;
+		curr_thread->fd_table_size = new_size;
+	}
 
-	return new_fd;
-}
\ No newline at end of file
+	curr_thread->fd_table[fd] = felem;
+	curr_thread->fd_free_hint = fd + 1;
+	felem->fd = fd;
+	return fd;
+}
@@ -19,6 +19,10 @@ off_t syscall_write(int fd, char* buffer, off_t size);
 void syscall_seek(int fd, unsigned position);
 unsigned syscall_tell(int fd);
 void syscall_close(int fd);
+#ifdef VM
+mapid_t syscall_mmap(int fd, void* addr);
+void syscall_munmap(mapid_t mapping);
+#endif
 
 bool syscall_chdir(const char* dir);
 bool syscall_mkdir(const char* dir);
@@ -26,10 +30,29 @@ bool syscall_readdir(int fd, char *name);
 bool syscall_isdir(int fd);
 int syscall_inumber(int fd);
 
+bool syscall_ftruncate(int fd, off_t length);
+bool syscall_fallocate(int fd, off_t offset, off_t length);
+int syscall_readdirplus(int fd, struct readdir_entry *entries, unsigned cnt);
+int syscall_pread(int fd, char* buffer, off_t size, off_t offset);
+off_t syscall_pwrite(int fd, char* buffer, off_t size, off_t offset);
+int syscall_readv(int fd, const struct iovec* uiov, int cnt);
+int syscall_writev(int fd, const struct iovec* uiov, int cnt);
+int syscall_ring_enter(struct ring* uring, unsigned to_submit);
+int syscall_copy_file_range(int in_fd, int out_fd, off_t length);
+int syscall_ttymode(int mode);
+int syscall_stats(struct syscall_stat* ustats, unsigned cnt, bool global);
+void syscall_print_stats(void);
+
+
+/* First fd handed out; 0 and 1 are the console. */
+#define FD_FIRST 2
+/* Initial number of slots in a process's fd table. */
+#define FD_TABLE_MIN_SIZE 16
 
 struct file_elem* get_file_elem(int fd);
 bool close_file(int fd);
-void close_all_file(struct list* fd_list);
-int set_new_fd(void);
+bool copy_all_file(struct thread* parent);
+void close_all_file(void);
+int set_new_fd(struct file_elem* felem);
 
 #endif /* userprog/syscall.h */
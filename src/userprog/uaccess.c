@@ -0,0 +1,108 @@
+#include "userprog/uaccess.h"
+#include <stdint.h>
+#include "threads/interrupt.h"
+#include "threads/vaddr.h"
+
+/* Copying to and from user memory.
+
+   Rather than walking the page directory to validate each user
+   pointer before touching it, the kernel just dereferences it
+   with one of the routines in user-copy.S.  A bad pointer then
+   page faults in kernel context, and page_fault() calls
+   uaccess_fixup() to resume at the routine's recovery path,
+   which reports the failure to the caller.  The only check made
+   up front is that the range lies entirely in user space, since
+   kernel addresses are always mapped. */
+
+size_t uaccess_copy (void *dst, const void *src, size_t size);
+int uaccess_get_byte (const uint8_t *uaddr);
+
+/* Labels in user-copy.S. */
+extern const char uaccess_copy_words[], uaccess_copy_bytes[];
+extern const char uaccess_copy_words_fixup[], uaccess_copy_done[];
+extern const char uaccess_get_byte_load[], uaccess_get_byte_fixup[];
+
+/* Instructions that may fault on a user address, and where to
+   resume when they do. */
+struct fixup
+  {
+    const void *insn;
+    const void *resume;
+  };
+
+static const struct fixup fixups[] =
+  {
+    {uaccess_copy_words, uaccess_copy_words_fixup},
+    {uaccess_copy_bytes, uaccess_copy_done},
+    {uaccess_get_byte_load, uaccess_get_byte_fixup},
+  };
+
+/* Returns true if the SIZE bytes starting at UADDR lie entirely
+   in user space. */
+static bool
+is_user_range (const void *uaddr, size_t size)
+{
+  return ((uintptr_t) uaddr < (uintptr_t) PHYS_BASE
+          && size <= (uintptr_t) PHYS_BASE - (uintptr_t) uaddr);
+}
+
+/* Copies SIZE bytes from user address USRC to kernel address DST.
+   Returns true if successful, false if any byte of USRC is not a
+   valid user address. */
+bool
+copy_from_user (void *dst, const void *usrc, size_t size)
+{
+  return is_user_range (usrc, size) && uaccess_copy (dst, usrc, size) == 0;
+}
+
+/* Copies SIZE bytes from kernel address SRC to user address UDST.
+   Returns true if successful, false if any byte of UDST is not a
+   valid user address. */
+bool
+copy_to_user (void *udst, const void *src, size_t size)
+{
+  return is_user_range (udst, size) && uaccess_copy (udst, src, size) == 0;
+}
+
+/* Copies the null-terminated string at user address USRC into
+   DST, a buffer of SIZE bytes.  Returns the string's length, or
+   -1 if USRC is not a valid user address or the string, with its
+   null terminator, does not fit in SIZE bytes. */
+int
+strncpy_from_user (char *dst, const char *usrc, size_t size)
+{
+  size_t i;
+
+  for (i = 0; i < size; i++)
+    {
+      int c;
+
+      if (!is_user_range (usrc + i, 1))
+        return -1;
+      c = uaccess_get_byte ((const uint8_t *) usrc + i);
+      if (c < 0)
+        return -1;
+      dst[i] = c;
+      if (c == '\0')
+        return i;
+    }
+  return -1;
+}
+
+/* Called by the page fault handler for faults in kernel context.
+   If F faulted in one of the user access routines, redirects it
+   to the routine's recovery path and returns true.  Otherwise
+   returns false, meaning the fault is a kernel bug. */
+bool
+uaccess_fixup (struct intr_frame *f)
+{
+  size_t i;
+
+  for (i = 0; i < sizeof fixups / sizeof *fixups; i++)
+    if ((const void *) f->eip == fixups[i].insn)
+      {
+        f->eip = (void (*) (void)) fixups[i].resume;
+        return true;
+      }
+  return false;
+}
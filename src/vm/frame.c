@@ -0,0 +1,238 @@
+#include "vm/frame.h"
+#include <debug.h>
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/thread.h"
+#include "userprog/image.h"
+#include "vm/page.h"
+
+/* Frame table.
+
+   Every user pool frame that holds a process's private page is
+   listed here.  When the pool runs dry, a victim is chosen with
+   the clock algorithm: the hand sweeps the list, giving each
+   recently accessed page a second chance by clearing its
+   accessed bit, and evicts the first page found unaccessed.
+
+   frame_lock protects the table and the binding between each
+   frame and its page.  Eviction unmaps the victim's pages and
+   marks the frame in transit under the lock, but drops the lock
+   while the frame is written to swap or to its file, so that
+   other faults are not held up behind the I/O.  Anyone who finds
+   a page in a frame in transit waits for the eviction to finish
+   with frame_wait() before touching it.
+
+   So that faulting processes rarely have to evict, and wait for
+   a dirty victim to be written to swap, a page-out daemon wakes
+   up when free user frames drop below a low watermark and evicts
+   pages ahead of time until a high watermark is restored. */
+
+/* Watermarks, as fractions of the user pool. */
+#define PAGEOUT_LOW_DIV 32              /* Wake the daemon below this. */
+#define PAGEOUT_HIGH_DIV 16             /* Daemon stops at this. */
+
+static struct list frames;              /* All frames. */
+static struct list_elem *hand;          /* Clock hand, or list_end. */
+static struct lock frame_lock;
+static struct condition evict_done;     /* Signaled after each eviction. */
+
+static size_t low_water, high_water;    /* Free frame watermarks. */
+static struct condition pageout_cond;   /* Signaled below low_water. */
+static thread_func pageout_daemon NO_RETURN;
+
+/* Initializes the frame table. */
+void
+frame_init (void) 
+{
+  list_init (&frames);
+  hand = list_end (&frames);
+  lock_init (&frame_lock);
+  cond_init (&evict_done);
+  cond_init (&pageout_cond);
+}
+
+/* Starts the page-out daemon.  Must be called after swap_init(),
+   since the daemon evicts to swap. */
+void
+frame_start_pageout (void) 
+{
+  size_t page_cnt = palloc_page_cnt (PAL_USER);
+
+  low_water = page_cnt / PAGEOUT_LOW_DIV;
+  high_water = page_cnt / PAGEOUT_HIGH_DIV;
+  if (low_water > 0)
+    thread_create ("pageout", PRI_DEFAULT, pageout_daemon, NULL);
+}
+
+/* Acquires the frame table lock. */
+void
+frame_lock_acquire (void) 
+{
+  lock_acquire (&frame_lock);
+}
+
+/* Releases the frame table lock. */
+void
+frame_lock_release (void) 
+{
+  lock_release (&frame_lock);
+}
+
+/* Advances the clock hand, wrapping around at the end. */
+static struct frame *
+advance_hand (void) 
+{
+  if (hand == list_end (&frames))
+    hand = list_begin (&frames);
+  else
+    {
+      hand = list_next (hand);
+      if (hand == list_end (&frames))
+        hand = list_begin (&frames);
+    }
+  if (hand == list_end (&frames))
+    return NULL;
+  return list_entry (hand, struct frame, elem);
+}
+
+/* Evicts a page chosen by the clock algorithm and returns its
+   now free frame, pinned, or a null pointer if no page can be
+   evicted.  Two sweeps suffice: the first clears every accessed
+   bit.  frame_lock is dropped while the victim is written out,
+   which pinning it keeps other evictors away from. */
+static struct frame *
+evict_frame (void) 
+{
+  size_t i;
+
+  ASSERT (lock_held_by_current_thread (&frame_lock));
+
+  for (i = 0; i < 2 * list_size (&frames); i++)
+    {
+      struct frame *f = advance_hand ();
+      bool evicted;
+
+      if (f == NULL)
+        break;
+      if (f->pinned)
+        continue;
+      if (page_accessed_recently (f))
+        continue;
+
+      f->pinned = f->in_transit = true;
+      evicted = page_evict (f);
+      f->in_transit = false;
+      cond_broadcast (&evict_done, &frame_lock);
+      if (evicted)
+        return f;
+      f->pinned = false;
+    }
+  return NULL;
+}
+
+/* Returns an empty, pinned frame, evicting another page if memory
+   is short, or a null pointer if no frame can be had.  The caller
+   fills the frame, adds its page to it and then calls
+   frame_unpin(). */
+struct frame *
+frame_alloc (void) 
+{
+  struct frame *f = NULL;
+  void *kpage;
+
+  do
+    kpage = palloc_get_page (PAL_USER);
+  while (kpage == NULL && image_reclaim ());
+
+  if (kpage != NULL)
+    {
+      f = malloc (sizeof *f);
+      if (f == NULL)
+        {
+          palloc_free_page (kpage);
+          return NULL;
+        }
+      f->kpage = kpage;
+    }
+
+  lock_acquire (&frame_lock);
+  if (f != NULL)
+    list_push_back (&frames, &f->elem);
+  else
+    f = evict_frame ();
+  if (palloc_free_cnt (PAL_USER) < low_water)
+    cond_signal (&pageout_cond, &frame_lock);
+  if (f != NULL)
+    {
+      list_init (&f->pages);
+      f->pinned = true;
+      f->in_transit = false;
+    }
+  lock_release (&frame_lock);
+  return f;
+}
+
+/* Removes F from the frame table and frees it.
+   The caller must hold the frame table lock. */
+void
+frame_free (struct frame *f) 
+{
+  ASSERT (lock_held_by_current_thread (&frame_lock));
+
+  if (hand == &f->elem)
+    hand = list_prev (hand);
+  list_remove (&f->elem);
+  palloc_free_page (f->kpage);
+  free (f);
+}
+
+/* Makes F eligible for eviction again. */
+void
+frame_unpin (struct frame *f) 
+{
+  lock_acquire (&frame_lock);
+  f->pinned = false;
+  lock_release (&frame_lock);
+}
+
+/* Waits for some eviction in progress to finish.  The caller
+   must hold the frame table lock, which is released while
+   waiting, and should recheck whatever frame it was waiting on. */
+void
+frame_wait (void) 
+{
+  cond_wait (&evict_done, &frame_lock);
+}
+
+/* Page-out daemon.  Sleeps until free user frames drop below
+   low_water, then evicts pages, writing dirty ones to swap, and
+   returns their frames to the user pool until high_water frames
+   are free.  Between evictions the daemon drops frame_lock and
+   yields, so that faulting processes waiting for the lock get it
+   rather than the daemon taking it straight back. */
+static void
+pageout_daemon (void *aux UNUSED) 
+{
+  lock_acquire (&frame_lock);
+  for (;;)
+    {
+      struct frame *f;
+
+      while (palloc_free_cnt (PAL_USER) >= low_water)
+        cond_wait (&pageout_cond, &frame_lock);
+
+      while (palloc_free_cnt (PAL_USER) < high_water
+             && (f = evict_frame ()) != NULL)
+        {
+          frame_free (f);
+          lock_release (&frame_lock);
+          thread_yield ();
+          lock_acquire (&frame_lock);
+        }
+
+      /* Nothing left to evict: wait for the next allocation. */
+      if (palloc_free_cnt (PAL_USER) < low_water)
+        cond_wait (&pageout_cond, &frame_lock);
+    }
+}
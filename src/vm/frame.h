@@ -0,0 +1,33 @@
+#ifndef VM_FRAME_H
+#define VM_FRAME_H
+
+#include <list.h>
+#include <stdbool.h>
+
+struct page;
+
+/* A physical frame in the user pool holding a private page.
+
+   After fork(), parent and child share their private frames
+   copy-on-write until one of them writes, so a frame may hold a
+   page of several processes at once.  The number of PAGES is the
+   frame's reference count. */
+struct frame
+  {
+    struct list_elem elem;              /* Element in frame table. */
+    void *kpage;                        /* Kernel virtual address. */
+    struct list pages;                  /* Pages held in this frame. */
+    bool pinned;                        /* Exempt from eviction? */
+    bool in_transit;                    /* Being written out? */
+  };
+
+void frame_init (void);
+void frame_start_pageout (void);
+struct frame *frame_alloc (void);
+void frame_free (struct frame *);
+void frame_unpin (struct frame *);
+void frame_wait (void);
+void frame_lock_acquire (void);
+void frame_lock_release (void);
+
+#endif /* vm/frame.h */
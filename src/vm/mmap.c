@@ -0,0 +1,141 @@
+#include "vm/mmap.h"
+#include <debug.h>
+#include <list.h>
+#include <round.h>
+#include "filesys/file.h"
+#include "threads/malloc.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "vm/page.h"
+
+/* Memory-mapped files.
+
+   A mapping enters one page per page of the file into the
+   process's page table.  Like an executable's pages, nothing is
+   read until the process touches a page; unlike them, a mapped
+   page that the process modifies is written back to the file,
+   when it is evicted or when the mapping goes away, rather than
+   to swap.  Each mapping holds its own reopened file, so it
+   survives the process closing the descriptor it was made from. */
+
+/* A mapping of a file into the address space. */
+struct mapping
+  {
+    struct list_elem elem;              /* Element in thread's mappings. */
+    mapid_t id;                         /* Mapping identifier. */
+    struct file *file;                  /* Mapped file. */
+    void *base;                         /* First mapped page. */
+    size_t page_cnt;                    /* Number of mapped pages. */
+  };
+
+/* Initializes the current process's list of mappings. */
+void
+mmap_table_init (void) 
+{
+  struct thread *t = thread_current ();
+
+  list_init (&t->mappings);
+  t->next_mapid = 0;
+}
+
+/* Removes the first PAGE_CNT pages of mapping M from the address
+   space, writing back those that were modified. */
+static void
+remove_pages (struct mapping *m, size_t page_cnt) 
+{
+  size_t i;
+
+  for (i = 0; i < page_cnt; i++)
+    page_remove ((uint8_t *) m->base + i * PGSIZE);
+}
+
+/* Maps FILE into the current process's address space starting at
+   ADDR.  Returns the new mapping's identifier, or MAP_FAILED if
+   ADDR is null or not page-aligned, FILE is empty, the range
+   overlaps pages already in use or the stack area, or memory is
+   short. */
+mapid_t
+mmap_map (struct file *file, void *addr) 
+{
+  struct thread *t = thread_current ();
+  struct mapping *m;
+  off_t length;
+  size_t i;
+
+  if (addr == NULL || pg_ofs (addr) != 0)
+    return MAP_FAILED;
+  length = file_length (file);
+  if (length <= 0 || page_in_stack_area ((uint8_t *) addr + length - 1)
+      || !is_user_vaddr ((uint8_t *) addr + length - 1))
+    return MAP_FAILED;
+
+  m = malloc (sizeof *m);
+  if (m == NULL)
+    return MAP_FAILED;
+  m->file = file_reopen (file);
+  if (m->file == NULL)
+    {
+      free (m);
+      return MAP_FAILED;
+    }
+  m->base = addr;
+  m->page_cnt = DIV_ROUND_UP (length, PGSIZE);
+
+  for (i = 0; i < m->page_cnt; i++)
+    {
+      off_t ofs = i * PGSIZE;
+      size_t read_bytes = length - ofs < PGSIZE ? length - ofs : PGSIZE;
+      if (!page_add_mmap ((uint8_t *) addr + ofs, m->file, ofs, read_bytes))
+        {
+          remove_pages (m, i);
+          file_close (m->file);
+          free (m);
+          return MAP_FAILED;
+        }
+    }
+
+  m->id = t->next_mapid++;
+  list_push_back (&t->mappings, &m->elem);
+  return m->id;
+}
+
+/* Undoes mapping M and frees it. */
+static void
+unmap (struct mapping *m) 
+{
+  list_remove (&m->elem);
+  remove_pages (m, m->page_cnt);
+  file_close (m->file);
+  free (m);
+}
+
+/* Removes the current process's mapping MAPPING, writing back
+   its modified pages.  Returns false if there is no such
+   mapping. */
+bool
+mmap_unmap (mapid_t mapping) 
+{
+  struct list *mappings = &thread_current ()->mappings;
+  struct list_elem *e;
+
+  for (e = list_begin (mappings); e != list_end (mappings); e = list_next (e))
+    {
+      struct mapping *m = list_entry (e, struct mapping, elem);
+      if (m->id == mapping)
+        {
+          unmap (m);
+          return true;
+        }
+    }
+  return false;
+}
+
+/* Removes all of the current process's mappings, as at exit. */
+void
+mmap_unmap_all (void) 
+{
+  struct list *mappings = &thread_current ()->mappings;
+
+  while (!list_empty (mappings))
+    unmap (list_entry (list_front (mappings), struct mapping, elem));
+}
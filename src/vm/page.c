@@ -0,0 +1,700 @@
+#include "vm/page.h"
+#include <debug.h>
+#include <string.h>
+#include "filesys/file.h"
+#include "threads/malloc.h"
+#include "threads/palloc.h"
+#include "threads/thread.h"
+#include "threads/vaddr.h"
+#include "userprog/image.h"
+#include "userprog/pagedir.h"
+#include "vm/frame.h"
+#include "vm/swap.h"
+
+/* Supplemental page table.
+
+   Each process keeps a hash table of the pages in its address
+   space, keyed by user virtual address, alongside its page
+   directory.  An executable's segments are entered here at load
+   time, but no frame is allocated or read until the process
+   faults on the page, so a process only pays for the pages it
+   actually touches.  Private pages live in frames from the frame
+   table and may be evicted to swap at any time they are not
+   pinned.  fork() copies the table, sharing frames and swap slots
+   between parent and child until one of them writes.
+
+   A page that would start out all zero is first mapped read-only
+   to the one zero page shared by all processes, and gets a frame
+   of its own only when written, so that large, sparsely used BSS
+   segments and stacks cost next to nothing. */
+
+size_t page_stack_limit = PAGE_STACK_LIMIT_DEFAULT;
+
+/* Pages in the aligned window around a faulting page that are
+   mapped at the same time if their contents are already in
+   memory. */
+#define FAULT_AROUND_PAGES 16
+
+/* File-backed pages read in after a fault that continues a
+   sequential scan. */
+#define READ_AHEAD_PAGES 4
+
+/* Page of zeros, mapped read-only by untouched zero pages. */
+static void *zero_page;
+
+static hash_hash_func page_hash;
+static hash_less_func page_less;
+
+/* Allocates the shared zero page. */
+void
+page_init (void) 
+{
+  zero_page = palloc_get_page (PAL_ASSERT | PAL_ZERO);
+}
+
+/* Initializes the current process's page table. */
+void
+page_table_init (void) 
+{
+  hash_init (&thread_current ()->pages, page_hash, page_less, NULL);
+}
+
+/* Writes resident mapped page P back to its file if it has been
+   modified.  The frame table lock must be held, unless P's frame
+   is in transit. */
+static void
+write_back (struct page *p) 
+{
+  if (pagedir_is_dirty (p->pagedir, p->upage))
+    p->modified = true;
+  if (p->modified)
+    {
+      file_write_at (p->file, p->kpage, p->read_bytes, p->ofs);
+      p->modified = false;
+    }
+}
+
+/* Adds P to the pages held in frame F.
+   The frame table lock must be held. */
+static void
+attach (struct page *p, struct frame *f) 
+{
+  list_push_back (&f->pages, &p->frame_elem);
+  p->frame = f;
+  p->kpage = f->kpage;
+}
+
+/* Removes P from its frame, freeing the frame if P was the last
+   page held in it.  The frame table lock must be held. */
+static void
+detach (struct page *p) 
+{
+  list_remove (&p->frame_elem);
+  if (list_empty (&p->frame->pages))
+    frame_free (p->frame);
+  p->frame = NULL;
+  p->kpage = NULL;
+}
+
+/* Remaps resident page P, read-only or WRITABLE, keeping track of
+   whether it was modified.  The frame table lock must be held. */
+static void
+remap (struct page *p, bool writable) 
+{
+  if (pagedir_is_dirty (p->pagedir, p->upage))
+    p->modified = true;
+  pagedir_clear_page (p->pagedir, p->upage);
+  pagedir_set_page (p->pagedir, p->upage, p->kpage, writable);
+}
+
+/* Waits until P's frame, if any, is no longer in transit, so
+   that P is either resident and mapped or fully evicted.  The
+   frame table lock must be held. */
+static void
+wait_for_eviction (struct page *p) 
+{
+  while (p->frame != NULL && p->frame->in_transit)
+    frame_wait ();
+}
+
+/* Frees page P, along with its private frame or swap slot, or
+   its share of them, writing it back first if it is mapped. */
+static void
+free_page (struct page *p) 
+{
+  frame_lock_acquire ();
+  wait_for_eviction (p);
+  if (p->frame != NULL)
+    {
+      if (p->mapped)
+        write_back (p);
+      pagedir_clear_page (p->pagedir, p->upage);
+      detach (p);
+    }
+  else if (p->kpage == zero_page)
+    pagedir_clear_page (p->pagedir, p->upage);
+  if (p->swap_slot != SWAP_NONE)
+    swap_free (p->swap_slot);
+  frame_lock_release ();
+  free (p);
+}
+
+/* Frees the page at hash element E. */
+static void
+destroy_page (struct hash_elem *e, void *aux UNUSED) 
+{
+  free_page (hash_entry (e, struct page, hash_elem));
+}
+
+/* Destroys the current process's page table, freeing its pages'
+   private frames and swap slots.  Shared frames are left for
+   image_close(). */
+void
+page_table_destroy (void) 
+{
+  hash_destroy (&thread_current ()->pages, destroy_page);
+}
+
+/* Returns the current process's page at UPAGE, or a null pointer
+   if there is none. */
+struct page *
+page_lookup (const void *upage) 
+{
+  struct page key;
+  struct hash_elem *e;
+
+  key.upage = (void *) upage;
+  e = hash_find (&thread_current ()->pages, &key.hash_elem);
+  return e != NULL ? hash_entry (e, struct page, hash_elem) : NULL;
+}
+
+/* Adds a page at UPAGE to the current process's address space,
+   as described in struct page.  Returns true if successful, false
+   if UPAGE is already in use or memory is short. */
+static bool
+add_page (void *upage, struct file *file, off_t ofs, size_t read_bytes,
+          bool writable, struct image *image, bool mapped) 
+{
+  struct page *p;
+
+  ASSERT (pg_ofs (upage) == 0);
+  ASSERT (read_bytes <= PGSIZE);
+
+  p = malloc (sizeof *p);
+  if (p == NULL)
+    return false;
+  p->upage = upage;
+  p->pagedir = thread_current ()->pagedir;
+  p->writable = writable;
+  p->kpage = NULL;
+  p->shared = false;
+  p->frame = NULL;
+  p->modified = false;
+  p->swap_slot = SWAP_NONE;
+  p->file = read_bytes > 0 ? file : NULL;
+  p->ofs = ofs;
+  p->read_bytes = p->file != NULL ? read_bytes : 0;
+  p->image = !writable ? image : NULL;
+  p->mapped = mapped;
+  if (hash_insert (&thread_current ()->pages, &p->hash_elem) != NULL)
+    {
+      free (p);
+      return false;
+    }
+  return true;
+}
+
+/* Adds a page at UPAGE to the current process's address space,
+   to be filled from FILE as described in struct page.  If the
+   page is read-only and IMAGE is nonnull, the frame is taken from
+   IMAGE and shared.  Returns true if successful, false if UPAGE
+   is already in use or memory is short. */
+bool
+page_add_file (void *upage, struct file *file, off_t ofs,
+               size_t read_bytes, bool writable, struct image *image) 
+{
+  return add_page (upage, file, ofs, read_bytes, writable, image, false);
+}
+
+/* Adds an all-zero page at UPAGE to the current process's
+   address space.  Returns true if successful, false if UPAGE is
+   already in use or memory is short. */
+bool
+page_add_zero (void *upage, bool writable) 
+{
+  return add_page (upage, NULL, 0, 0, writable, NULL, false);
+}
+
+/* Adds a writable page at UPAGE to the current process's address
+   space that maps READ_BYTES bytes of FILE at offset OFS, which
+   must be nonzero.  Returns true if successful, false if UPAGE is
+   already in use or memory is short. */
+bool
+page_add_mmap (void *upage, struct file *file, off_t ofs,
+               size_t read_bytes) 
+{
+  ASSERT (read_bytes > 0);
+  return add_page (upage, file, ofs, read_bytes, true, NULL, true);
+}
+
+/* Removes the page at UPAGE, if any, from the current process's
+   address space, writing it back first if it is mapped. */
+void
+page_remove (void *upage) 
+{
+  struct page *p = page_lookup (upage);
+
+  if (p != NULL)
+    {
+      hash_delete (&thread_current ()->pages, &p->hash_elem);
+      free_page (p);
+    }
+}
+
+/* Fills the frame at KPAGE with P's contents, from swap if P
+   was evicted there, otherwise from its file.  P keeps its swap
+   slot, if any, until the frame is mapped.
+   Returns true if successful, false on read error. */
+static bool
+fill_frame (struct page *p, void *kpage) 
+{
+  if (p->swap_slot != SWAP_NONE)
+    {
+      swap_in (p->swap_slot, kpage);
+      return true;
+    }
+  if (p->file != NULL
+      && file_read_at (p->file, kpage, p->read_bytes, p->ofs)
+         != (off_t) p->read_bytes)
+    return false;
+  memset ((uint8_t *) kpage + p->read_bytes, 0, PGSIZE - p->read_bytes);
+  return true;
+}
+
+/* Gets a frame for P, fills it with P's contents and maps it
+   into the current process's page directory.  Unless WRITE, an
+   all-zero page is mapped to the zero page instead.
+   Returns true if successful, false otherwise. */
+bool
+page_load (struct page *p, bool write) 
+{
+  struct frame *f;
+  void *kpage = NULL;
+
+  ASSERT (p->kpage == NULL);
+
+  if (p->image != NULL)
+    kpage = image_get_page (p->image, p->upage, p->ofs, p->read_bytes);
+  else if (!write && p->file == NULL && p->swap_slot == SWAP_NONE)
+    kpage = zero_page;
+  if (kpage != NULL)
+    {
+      if (!pagedir_set_page (p->pagedir, p->upage, kpage,
+                             p->writable && kpage != zero_page))
+        return false;
+      p->shared = true;
+      p->kpage = kpage;
+      return true;
+    }
+
+  /* The frame stays pinned, and so out of the evictor's reach,
+     until it is filled and mapped.  A page read from swap gives
+     up its slot only then, so that a failed mapping loses
+     nothing. */
+  f = frame_alloc ();
+  if (f == NULL)
+    return false;
+  if (!fill_frame (p, f->kpage)
+      || !pagedir_set_page (p->pagedir, p->upage, f->kpage, p->writable))
+    {
+      frame_lock_acquire ();
+      frame_free (f);
+      frame_lock_release ();
+      return false;
+    }
+  frame_lock_acquire ();
+  attach (p, f);
+  if (p->swap_slot != SWAP_NONE)
+    {
+      swap_free (p->swap_slot);
+      p->swap_slot = SWAP_NONE;
+    }
+  frame_lock_release ();
+  frame_unpin (f);
+  return true;
+}
+
+/* Maps P, which is not resident, if its contents are already in
+   memory, as a cached image page or the zero page, without any
+   I/O or frame allocation. */
+static void
+map_if_cached (struct page *p) 
+{
+  void *kpage = NULL;
+
+  if (p->image != NULL)
+    kpage = image_find_page (p->image, p->upage, p->ofs, p->read_bytes);
+  else if (p->file == NULL && p->swap_slot == SWAP_NONE)
+    kpage = zero_page;
+  if (kpage != NULL
+      && pagedir_set_page (p->pagedir, p->upage, kpage,
+                           p->writable && kpage != zero_page))
+    {
+      p->shared = true;
+      p->kpage = kpage;
+    }
+}
+
+/* After a fault on page P, maps the other pages in P's window
+   whose contents are already in memory, so that the process does
+   not fault on each of them in turn.  If P was read from swap
+   slot SLOT, pages in the window swapped out to the same cluster
+   are read in too, while the disk head is there.  Otherwise, if
+   the page below P is resident, the fault looks like part of a
+   sequential scan, so the file-backed pages following P are read
+   in. */
+static void
+fault_around (struct page *p, size_t slot) 
+{
+  uint8_t *base = (uint8_t *) p->upage
+                  - pg_no (p->upage) % FAULT_AROUND_PAGES * PGSIZE;
+  struct page *q;
+  int i;
+
+  for (i = 0; i < FAULT_AROUND_PAGES; i++)
+    {
+      q = page_lookup (base + i * PGSIZE);
+      if (q != NULL && q != p && q->kpage == NULL)
+        map_if_cached (q);
+    }
+
+  /* Keep any read-ahead from evicting P before the process gets
+     to touch it. */
+  pagedir_set_accessed (p->pagedir, p->upage, true);
+
+  if (slot != SWAP_NONE)
+    {
+      for (i = 0; i < FAULT_AROUND_PAGES; i++)
+        {
+          q = page_lookup (base + i * PGSIZE);
+          if (q != NULL && q->kpage == NULL
+              && swap_same_cluster (slot, q->swap_slot)
+              && !page_load (q, false))
+            break;
+        }
+      return;
+    }
+
+  if (p->file == NULL)
+    return;
+  q = page_lookup ((uint8_t *) p->upage - PGSIZE);
+  if (q == NULL || q->kpage == NULL)
+    return;
+  for (i = 1; i <= READ_AHEAD_PAGES; i++)
+    {
+      q = page_lookup ((uint8_t *) p->upage + i * PGSIZE);
+      if (q == NULL || q->file == NULL)
+        break;
+      if (q->kpage == NULL && !page_load (q, false))
+        break;
+    }
+}
+
+/* Brings in the current process's page containing user address
+   ADDR, after a not-present page fault on it, caused by a write
+   if WRITE.  Returns true if successful, including when the page
+   turns out to be mapped already, having been remapped after an
+   eviction that failed, and false if ADDR is not part of the
+   address space or cannot be loaded. */
+bool
+page_fault_in (const void *addr, bool write) 
+{
+  struct page *p;
+  bool resident;
+  size_t slot;
+
+  if (!is_user_vaddr (addr) || thread_current ()->pagedir == NULL)
+    return false;
+  p = page_lookup (pg_round_down (addr));
+  if (p == NULL)
+    return false;
+
+  /* Waits out any eviction of P in progress. */
+  frame_lock_acquire ();
+  wait_for_eviction (p);
+  resident = p->kpage != NULL;
+  slot = p->swap_slot;
+  frame_lock_release ();
+  if (resident)
+    return pagedir_get_page (p->pagedir, p->upage) != NULL;
+  if (!page_load (p, write))
+    return false;
+  fault_around (p, slot);
+  return true;
+}
+
+/* Returns true if user address ADDR lies in the area reserved for
+   the stack, the top page_stack_limit bytes of user memory. */
+bool
+page_in_stack_area (const void *addr) 
+{
+  return (is_user_vaddr (addr)
+          && (size_t) ((uint8_t *) PHYS_BASE - (uint8_t *) addr)
+             <= page_stack_limit);
+}
+
+/* Grows the current process's stack down to cover ADDR, after a
+   not-present fault on it, if ADDR looks like a stack access
+   given user stack pointer ESP: at or above ESP, or up to 32
+   bytes below it, as touched by PUSHA.  Only the faulting page is
+   added; the ones between it and the old bottom of the stack are
+   added when they, too, are touched.  Returns true if successful,
+   false if ADDR is not a stack access or lies beyond the stack
+   limit. */
+bool
+page_grow_stack (const void *addr, const void *esp) 
+{
+  void *upage = pg_round_down (addr);
+
+  if (!page_in_stack_area (addr) || thread_current ()->pagedir == NULL
+      || (const uint8_t *) addr + 32 < (const uint8_t *) esp)
+    return false;
+  return page_add_zero (upage, true) && page_fault_in (upage, true);
+}
+
+/* Gives the current process's page containing user address ADDR
+   a private, writable copy of its frame, after a write fault on a
+   page it shares copy-on-write or that is mapped to the zero
+   page.  If no other process still shares the frame, the page is
+   just made writable.  Returns true if
+   successful, false if ADDR is not in a writable page of the
+   address space or memory is short.  If the copy cannot be
+   mapped, the page still holds it, so nothing is lost. */
+bool
+page_unshare (const void *addr) 
+{
+  struct frame *f = NULL;
+  struct page *p;
+  bool success;
+
+  if (!is_user_vaddr (addr) || thread_current ()->pagedir == NULL)
+    return false;
+  p = page_lookup (pg_round_down (addr));
+  if (p == NULL || !p->writable)
+    return false;
+
+  for (;;)
+    {
+      frame_lock_acquire ();
+      wait_for_eviction (p);
+      if (p->kpage == NULL
+          || (p->frame != NULL && list_size (&p->frame->pages) == 1))
+        {
+          /* Either evicted meanwhile, in which case retrying the
+             access faults it back in privately, or no longer
+             shared. */
+          if (p->kpage != NULL)
+            remap (p, true);
+          if (f != NULL)
+            frame_free (f);
+          frame_lock_release ();
+          return true;
+        }
+      if (f != NULL)
+        break;
+
+      /* Get a frame for the copy, then check again. */
+      frame_lock_release ();
+      f = frame_alloc ();
+      if (f == NULL)
+        return false;
+    }
+
+  memcpy (f->kpage, p->kpage, PGSIZE);
+  if (pagedir_is_dirty (p->pagedir, p->upage))
+    p->modified = true;
+  pagedir_clear_page (p->pagedir, p->upage);
+  if (p->frame != NULL)
+    detach (p);
+  else
+    p->shared = false;
+  attach (p, f);
+  success = pagedir_set_page (p->pagedir, p->upage, p->kpage, true);
+  frame_lock_release ();
+  frame_unpin (f);
+  return success;
+}
+
+/* Adds to CHILD's page table a copy of PARENT's page Q, sharing
+   Q's frame or swap slot.  Returns true if successful, false if
+   memory is short.  The frame table lock must be held. */
+static bool
+copy_page (struct thread *child, struct thread *parent, struct page *q) 
+{
+  struct page *p = malloc (sizeof *p);
+
+  if (p == NULL)
+    return false;
+  *p = *q;
+  p->pagedir = child->pagedir;
+  p->kpage = NULL;
+  p->shared = false;
+  p->frame = NULL;
+  if (q->file != NULL && q->file == parent->exe_file)
+    p->file = child->exe_file;
+  if (q->image != NULL)
+    p->image = child->exe_image;
+
+  if (q->frame != NULL)
+    {
+      if (!pagedir_set_page (p->pagedir, p->upage, q->kpage, false))
+        {
+          free (p);
+          return false;
+        }
+      if (q->writable)
+        remap (q, false);
+      p->modified = q->modified;
+      attach (p, q->frame);
+    }
+  if (p->swap_slot != SWAP_NONE)
+    swap_dup (p->swap_slot);
+  hash_insert (&child->pages, &p->hash_elem);
+  return true;
+}
+
+/* Fills the current process's empty page table with a copy of
+   PARENT's, for fork().  Writable pages resident in PARENT become
+   copy-on-write in both processes.  Memory-mapped files are not
+   inherited.  PARENT must not run meanwhile.  Returns true if
+   successful, false if memory is short. */
+bool
+page_table_copy (struct thread *parent) 
+{
+  struct thread *t = thread_current ();
+  struct hash_iterator i;
+  bool success = true;
+
+  frame_lock_acquire ();
+  hash_first (&i, &parent->pages);
+  while (success && hash_next (&i))
+    {
+      struct page *q = hash_entry (hash_cur (&i), struct page, hash_elem);
+      wait_for_eviction (q);
+      if (!q->mapped)
+        success = copy_page (t, parent, q);
+    }
+  frame_lock_release ();
+  return success;
+}
+
+/* Returns true if any page in frame F has been accessed since the
+   last call, and clears their accessed bits.  The frame table
+   lock must be held. */
+bool
+page_accessed_recently (struct frame *f) 
+{
+  struct list_elem *e;
+  bool accessed = false;
+
+  for (e = list_begin (&f->pages); e != list_end (&f->pages);
+       e = list_next (e))
+    {
+      struct page *p = list_entry (e, struct page, frame_elem);
+      if (pagedir_is_accessed (p->pagedir, p->upage))
+        {
+          pagedir_set_accessed (p->pagedir, p->upage, false);
+          accessed = true;
+        }
+    }
+  return accessed;
+}
+
+/* Evicts the pages held in frame F, writing them to swap, or back
+   to its file for a mapped page, if they have been modified;
+   unmodified pages are simply dropped, to be read again from
+   their file or zeroed on the next fault.  Pages sharing F share
+   the one swap slot.  Returns true if successful, false if swap
+   is full, in which case the pages are mapped again.  The frame
+   table lock must be held and F marked in transit; the lock is
+   released during I/O. */
+bool
+page_evict (struct frame *f) 
+{
+  struct list_elem *e;
+  struct page *p;
+  bool modified = false;
+  size_t slot = SWAP_NONE;
+
+  ASSERT (!list_empty (&f->pages));
+
+  /* Unmap first, so no process can modify the frame while it is
+     written out. */
+  for (e = list_begin (&f->pages); e != list_end (&f->pages);
+       e = list_next (e))
+    {
+      p = list_entry (e, struct page, frame_elem);
+      if (pagedir_is_dirty (p->pagedir, p->upage))
+        p->modified = true;
+      pagedir_clear_page (p->pagedir, p->upage);
+      modified = modified || p->modified;
+    }
+
+  /* Mapped pages are never shared. */
+  p = list_entry (list_front (&f->pages), struct page, frame_elem);
+  if (modified)
+    {
+      frame_lock_release ();
+      if (p->mapped)
+        write_back (p);
+      else
+        slot = swap_out (f->kpage);
+      frame_lock_acquire ();
+    }
+  if (modified && !p->mapped)
+    {
+      for (e = list_begin (&f->pages); e != list_end (&f->pages);
+           e = list_next (e))
+        {
+          p = list_entry (e, struct page, frame_elem);
+          if (slot == SWAP_NONE)
+            pagedir_set_page (p->pagedir, p->upage, p->kpage,
+                              p->writable && list_size (&f->pages) == 1);
+          else
+            {
+              if (e != list_begin (&f->pages))
+                swap_dup (slot);
+              p->swap_slot = slot;
+              p->modified = true;
+            }
+        }
+      if (slot == SWAP_NONE)
+        return false;
+    }
+
+  while (!list_empty (&f->pages))
+    {
+      p = list_entry (list_pop_front (&f->pages), struct page, frame_elem);
+      p->kpage = NULL;
+      p->frame = NULL;
+    }
+  return true;
+}
+
+/* Hashes a page by its user address. */
+static unsigned
+page_hash (const struct hash_elem *e, void *aux UNUSED) 
+{
+  const struct page *p = hash_entry (e, struct page, hash_elem);
+  return hash_bytes (&p->upage, sizeof p->upage);
+}
+
+/* Orders pages by user address. */
+static bool
+page_less (const struct hash_elem *a_, const struct hash_elem *b_,
+           void *aux UNUSED) 
+{
+  const struct page *a = hash_entry (a_, struct page, hash_elem);
+  const struct page *b = hash_entry (b_, struct page, hash_elem);
+  return a->upage < b->upage;
+}
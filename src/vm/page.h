@@ -0,0 +1,78 @@
+#ifndef VM_PAGE_H
+#define VM_PAGE_H
+
+#include <hash.h>
+#include <list.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "filesys/off_t.h"
+
+struct file;
+struct frame;
+struct image;
+struct thread;
+
+/* A page of a process's user address space, resident or not.
+
+   The page's initial contents are READ_BYTES bytes read from
+   FILE at offset OFS, followed by zeros; a page with a null FILE
+   starts out all zero.  Nothing is read until the process first
+   touches the page.  Once modified, a page's contents live in its
+   frame or, after eviction, in swap slot SWAP_SLOT, except that a
+   MAPPED page is written back to FILE instead.
+
+   KPAGE, FRAME and SWAP_SLOT may change under eviction by another
+   process, so they are protected by the frame table lock.
+
+   A page inherited through fork() shares its parent's frame or
+   swap slot until either process writes to it.  While its frame
+   is shared, a writable page is mapped read-only, so that the
+   first write faults and takes a private copy. */
+struct page
+  {
+    struct hash_elem hash_elem;         /* Element in thread's pages. */
+    void *upage;                        /* User virtual address. */
+    uint32_t *pagedir;                  /* Owning page directory. */
+    bool writable;                      /* Writable by the process? */
+    void *kpage;                        /* Frame, or null if not resident. */
+    bool shared;                        /* KPAGE is IMAGE's or zero page? */
+    struct frame *frame;                /* Private frame, or null. */
+    struct list_elem frame_elem;        /* Element in FRAME's pages. */
+    bool modified;                      /* Differs from initial contents? */
+    size_t swap_slot;                   /* Swap slot, or SWAP_NONE. */
+
+    /* Initial contents. */
+    struct file *file;                  /* File to read, or null. */
+    off_t ofs;                          /* Offset in FILE. */
+    size_t read_bytes;                  /* Bytes to read; rest is zero. */
+    struct image *image;                /* Shared copy source, or null. */
+    bool mapped;                        /* Write back to FILE? */
+  };
+
+/* Default limit on the size of a process's stack. */
+#define PAGE_STACK_LIMIT_DEFAULT (8 * 1024 * 1024)
+
+/* Most bytes a process's stack may grow to. */
+extern size_t page_stack_limit;
+
+void page_init (void);
+void page_table_init (void);
+void page_table_destroy (void);
+bool page_table_copy (struct thread *parent);
+struct page *page_lookup (const void *upage);
+bool page_add_file (void *upage, struct file *, off_t ofs,
+                    size_t read_bytes, bool writable, struct image *);
+bool page_add_zero (void *upage, bool writable);
+bool page_add_mmap (void *upage, struct file *, off_t ofs,
+                    size_t read_bytes);
+void page_remove (void *upage);
+bool page_load (struct page *, bool write);
+bool page_fault_in (const void *addr, bool write);
+bool page_in_stack_area (const void *addr);
+bool page_grow_stack (const void *addr, const void *esp);
+bool page_unshare (const void *addr);
+bool page_accessed_recently (struct frame *);
+bool page_evict (struct frame *);
+
+#endif /* vm/page.h */
@@ -0,0 +1,188 @@
+#include "vm/swap.h"
+#include <bitmap.h>
+#include <debug.h>
+#include <stdio.h>
+#include "devices/block.h"
+#include "threads/malloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+#include "vm/zswap.h"
+
+/* Swap area.
+
+   The swap block device is divided into page-sized slots, each
+   SECTORS_PER_SLOT sectors long, allocated with a bitmap.  A page
+   shared copy-on-write by several processes is swapped out once,
+   to a slot shared by all of them, so each slot also has a
+   reference count.
+
+   Pages are offered to the compressed tier in zswap.c first, and
+   only go to the device if it declines them.  Slot numbers from
+   ZSWAP_SLOT_BASE up name compressed entries. */
+
+/* Device slots are handed out in runs of SWAP_CLUSTER contiguous
+   slots, so that pages evicted one after another, as by the
+   page-out daemon, are written close together, and can be read
+   back together by swap_same_cluster() read-ahead.  I/O is still
+   one sector at a time, since that is all the block layer offers,
+   but the run is sequential on disk. */
+#define SWAP_CLUSTER 8
+
+/* First slot number naming a compressed entry. */
+#define ZSWAP_SLOT_BASE ((size_t) 1 << 30)
+
+/* Sectors in one swap slot. */
+#define SECTORS_PER_SLOT (PGSIZE / BLOCK_SECTOR_SIZE)
+
+static struct block *swap_device;       /* Swap device, or null. */
+static struct bitmap *used_slots;       /* Slots in use. */
+static uint16_t *slot_refs;             /* Each slot's reference count. */
+static size_t cluster_next;             /* Next slot in current cluster. */
+static size_t cluster_end;              /* End of current cluster. */
+static struct lock swap_lock;           /* Protects the above. */
+
+/* Sets up swap on the block device in the BLOCK_SWAP role, and
+   the compressed tier in front of it.  Without a swap device,
+   pages that the compressed tier declines cannot be swapped. */
+void
+swap_init (void) 
+{
+  size_t slot_cnt = 0;
+
+  lock_init (&swap_lock);
+  swap_device = block_get_role (BLOCK_SWAP);
+  if (swap_device != NULL)
+    slot_cnt = block_size (swap_device) / SECTORS_PER_SLOT;
+  else
+    printf ("swap: no swap device, compressed swap only\n");
+  used_slots = bitmap_create (slot_cnt);
+  slot_refs = calloc (slot_cnt + 1, sizeof *slot_refs);
+  if (used_slots == NULL || slot_refs == NULL)
+    PANIC ("swap: out of memory");
+  zswap_init ();
+}
+
+/* Allocates a device slot, the next one in the current cluster if
+   it is still free, otherwise the first of a new cluster, or any
+   free slot if there is no room for a cluster.  Returns
+   BITMAP_ERROR if the device is full.  swap_lock must be held. */
+static size_t
+alloc_slot (void) 
+{
+  size_t slot;
+
+  if (cluster_next < cluster_end && !bitmap_test (used_slots, cluster_next))
+    slot = cluster_next++;
+  else
+    {
+      slot = bitmap_scan (used_slots, 0, SWAP_CLUSTER, false);
+      if (slot != BITMAP_ERROR)
+        {
+          cluster_next = slot + 1;
+          cluster_end = slot + SWAP_CLUSTER;
+        }
+      else
+        {
+          slot = bitmap_scan (used_slots, 0, 1, false);
+          cluster_next = cluster_end = 0;
+        }
+    }
+  if (slot != BITMAP_ERROR)
+    {
+      bitmap_mark (used_slots, slot);
+      slot_refs[slot] = 1;
+    }
+  return slot;
+}
+
+/* Writes the page at KPAGE to a free swap slot and returns the
+   slot, with one reference, or SWAP_NONE if swap is full or
+   absent. */
+size_t
+swap_out (const void *kpage) 
+{
+  size_t slot;
+  int i;
+
+  slot = zswap_store (kpage);
+  if (slot != SWAP_NONE)
+    return ZSWAP_SLOT_BASE + slot;
+
+  lock_acquire (&swap_lock);
+  slot = alloc_slot ();
+  lock_release (&swap_lock);
+  if (slot == BITMAP_ERROR)
+    return SWAP_NONE;
+
+  for (i = 0; i < SECTORS_PER_SLOT; i++)
+    block_write (swap_device, slot * SECTORS_PER_SLOT + i,
+                 (const uint8_t *) kpage + i * BLOCK_SECTOR_SIZE);
+  return slot;
+}
+
+/* Reads swap slot SLOT into the page at KPAGE.  The slot keeps
+   its reference; the caller drops it with swap_free() once the
+   page is safely mapped. */
+void
+swap_in (size_t slot, void *kpage) 
+{
+  int i;
+
+  ASSERT (slot != SWAP_NONE);
+
+  if (slot >= ZSWAP_SLOT_BASE)
+    {
+      zswap_load (slot - ZSWAP_SLOT_BASE, kpage);
+      return;
+    }
+  for (i = 0; i < SECTORS_PER_SLOT; i++)
+    block_read (swap_device, slot * SECTORS_PER_SLOT + i,
+                (uint8_t *) kpage + i * BLOCK_SECTOR_SIZE);
+}
+
+/* Adds a reference to swap slot SLOT. */
+void
+swap_dup (size_t slot) 
+{
+  ASSERT (slot != SWAP_NONE);
+
+  if (slot >= ZSWAP_SLOT_BASE)
+    {
+      zswap_dup (slot - ZSWAP_SLOT_BASE);
+      return;
+    }
+  lock_acquire (&swap_lock);
+  ASSERT (bitmap_test (used_slots, slot));
+  slot_refs[slot]++;
+  lock_release (&swap_lock);
+}
+
+/* Drops a reference to swap slot SLOT without reading it, freeing
+   the slot when the last one goes. */
+void
+swap_free (size_t slot) 
+{
+  ASSERT (slot != SWAP_NONE);
+
+  if (slot >= ZSWAP_SLOT_BASE)
+    {
+      zswap_free (slot - ZSWAP_SLOT_BASE);
+      return;
+    }
+  lock_acquire (&swap_lock);
+  ASSERT (bitmap_test (used_slots, slot));
+  if (--slot_refs[slot] == 0)
+    bitmap_reset (used_slots, slot);
+  lock_release (&swap_lock);
+}
+
+/* Returns true if SLOT and OTHER are both device slots close
+   enough together to have been allocated from the same cluster,
+   so that reading one after the other is nearly sequential. */
+bool
+swap_same_cluster (size_t slot, size_t other) 
+{
+  if (slot >= ZSWAP_SLOT_BASE || other >= ZSWAP_SLOT_BASE)
+    return false;
+  return (slot < other ? other - slot : slot - other) < SWAP_CLUSTER;
+}
@@ -0,0 +1,345 @@
+#include "vm/zswap.h"
+#include <bitmap.h>
+#include <debug.h>
+#include <round.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "threads/palloc.h"
+#include "threads/synch.h"
+#include "threads/vaddr.h"
+#include "vm/swap.h"
+
+/* Compressed swap tier.
+
+   Before going to the swap device, an evicted page is compressed
+   with a small LZ77 compressor into an arena carved out of the
+   kernel pool, so that swapping in is a decompression rather than
+   a disk read.  Anonymous pages are mostly zeros or repetitive
+   tables and usually shrink severalfold.  The arena is
+   zswap_size bytes, set with the -zswap boot option, and is
+   divided into ZSWAP_CHUNK-byte chunks, allocated as contiguous
+   runs with a bitmap.  A page that does not shrink to
+   ZSWAP_MAX_LEN bytes, or that finds the arena full, goes to the
+   swap device instead.
+
+   Each stored page is a small header followed by its compressed
+   data, so bookkeeping costs nothing for pages not stored, and an
+   entry is named by its first chunk.  Like swap slots, entries
+   are reference counted, because a page shared copy-on-write by
+   several processes is stored once. */
+
+size_t zswap_size = ZSWAP_SIZE_DEFAULT;
+
+/* Allocation unit within the arena, in bytes. */
+#define ZSWAP_CHUNK 64
+
+/* Largest compressed page worth keeping. */
+#define ZSWAP_MAX_LEN (PGSIZE * 3 / 4)
+
+/* A compressed page, at the start of its run of chunks. */
+struct zswap_entry
+  {
+    uint16_t len;                       /* Compressed length in bytes. */
+    uint16_t refs;                      /* Reference count. */
+    uint8_t data[];                     /* Compressed data. */
+  };
+
+static uint8_t *arena;                  /* Compressed pages. */
+static struct bitmap *used_chunks;      /* Arena chunks in use. */
+static struct lock zswap_lock;          /* Protects all of the above. */
+
+/* Compressor state and output buffer, protected by zswap_lock. */
+#define LZ_HASH_BITS 12
+static uint16_t lz_table[1 << LZ_HASH_BITS];
+static uint8_t lz_buf[ZSWAP_MAX_LEN];
+
+static size_t lz_compress (const uint8_t *, size_t, uint8_t *, size_t);
+static bool lz_decompress (const uint8_t *, size_t, uint8_t *, size_t);
+
+/* Returns the entry starting at CHUNK. */
+static struct zswap_entry *
+chunk_entry (size_t chunk) 
+{
+  return (struct zswap_entry *) (arena + chunk * ZSWAP_CHUNK);
+}
+
+/* Returns the number of chunks taken by an entry of LEN bytes of
+   compressed data. */
+static size_t
+entry_chunks (size_t len) 
+{
+  return DIV_ROUND_UP (sizeof (struct zswap_entry) + len, ZSWAP_CHUNK);
+}
+
+/* Sets up a compressed swap arena of zswap_size bytes, rounded
+   down to whole pages.  A size of 0 disables the tier. */
+void
+zswap_init (void) 
+{
+  size_t page_cnt = zswap_size / PGSIZE;
+  size_t chunk_cnt = page_cnt * (PGSIZE / ZSWAP_CHUNK);
+
+  lock_init (&zswap_lock);
+  arena = page_cnt > 0 ? palloc_get_multiple (0, page_cnt) : NULL;
+  if (arena == NULL)
+    {
+      if (page_cnt > 0)
+        printf ("zswap: cannot allocate %zu kB arena\n", zswap_size / 1024);
+      chunk_cnt = 0;
+    }
+  used_chunks = bitmap_create (chunk_cnt);
+  if (used_chunks == NULL)
+    PANIC ("zswap: out of memory");
+  printf ("zswap: %zu kB compressed swap arena\n",
+          chunk_cnt * ZSWAP_CHUNK / 1024);
+}
+
+/* Compresses the page at KPAGE into the arena and returns its
+   entry, with one reference, or SWAP_NONE if it does not compress
+   well or the arena is full. */
+size_t
+zswap_store (const void *kpage) 
+{
+  size_t len, chunk = SWAP_NONE;
+  struct zswap_entry *e;
+
+  if (arena == NULL)
+    return SWAP_NONE;
+
+  lock_acquire (&zswap_lock);
+  len = lz_compress (kpage, PGSIZE, lz_buf, sizeof lz_buf);
+  if (len == 0)
+    goto done;
+  chunk = bitmap_scan_and_flip (used_chunks, 0, entry_chunks (len), false);
+  if (chunk == BITMAP_ERROR)
+    {
+      chunk = SWAP_NONE;
+      goto done;
+    }
+
+  e = chunk_entry (chunk);
+  e->len = len;
+  e->refs = 1;
+  memcpy (e->data, lz_buf, len);
+
+ done:
+  lock_release (&zswap_lock);
+  return chunk;
+}
+
+/* Decompresses ENTRY into the page at KPAGE.  The entry keeps its
+   reference. */
+void
+zswap_load (size_t entry, void *kpage) 
+{
+  struct zswap_entry *e = chunk_entry (entry);
+  bool ok;
+
+  lock_acquire (&zswap_lock);
+  ASSERT (bitmap_test (used_chunks, entry));
+  ok = lz_decompress (e->data, e->len, kpage, PGSIZE);
+  lock_release (&zswap_lock);
+  if (!ok)
+    PANIC ("zswap: entry %zu is corrupt", entry);
+}
+
+/* Adds a reference to ENTRY. */
+void
+zswap_dup (size_t entry) 
+{
+  lock_acquire (&zswap_lock);
+  ASSERT (bitmap_test (used_chunks, entry));
+  chunk_entry (entry)->refs++;
+  lock_release (&zswap_lock);
+}
+
+/* Drops a reference to ENTRY, freeing it and its chunks when the
+   last one goes. */
+void
+zswap_free (size_t entry) 
+{
+  struct zswap_entry *e = chunk_entry (entry);
+
+  lock_acquire (&zswap_lock);
+  ASSERT (bitmap_test (used_chunks, entry));
+  if (--e->refs == 0)
+    bitmap_set_multiple (used_chunks, entry, entry_chunks (e->len), false);
+  lock_release (&zswap_lock);
+}
+
+/* LZ compressor.
+
+   The output is a series of sequences, each a token byte, a run
+   of literal bytes, and a match: a two-byte little-endian offset
+   back into the output to copy from.  The token's upper nibble
+   is the number of literals and its lower nibble the match
+   length minus LZ_MIN_MATCH; a nibble of 15 is followed by bytes
+   to add to it, up to and including the first one less than 255.
+   The final sequence has literals only.  This is the LZ4 block
+   format, minus its end-of-block restrictions. */
+
+/* Shortest match worth encoding. */
+#define LZ_MIN_MATCH 4
+
+/* Reads 4 unaligned bytes at P. */
+static inline uint32_t
+load32 (const uint8_t *p) 
+{
+  uint32_t x;
+  memcpy (&x, p, sizeof x);
+  return x;
+}
+
+/* Hashes the 4 bytes in X into lz_table. */
+static inline unsigned
+lz_hash (uint32_t x) 
+{
+  return (x * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+/* Appends the extension bytes for a length nibble of 15 and
+   remaining length LEN to *OP. */
+static uint8_t *
+put_length (uint8_t *op, size_t len) 
+{
+  for (; len >= 255; len -= 255)
+    *op++ = 255;
+  *op++ = len;
+  return op;
+}
+
+/* Appends a sequence of LIT_LEN literals at LIT and, if MATCH_LEN
+   is nonzero, a match of MATCH_LEN bytes at OFFSET, to the output
+   at *OPP, which ends at OP_END.  Returns false if there is not
+   enough room. */
+static bool
+put_sequence (uint8_t **opp, uint8_t *op_end, const uint8_t *lit,
+              size_t lit_len, size_t offset, size_t match_len) 
+{
+  uint8_t *op = *opp;
+  size_t ml = match_len > 0 ? match_len - LZ_MIN_MATCH : 0;
+  size_t need = 1 + lit_len + lit_len / 255 + 1 + 2 + ml / 255 + 1;
+
+  if ((size_t) (op_end - op) < need)
+    return false;
+
+  *op++ = (lit_len < 15 ? lit_len : 15) << 4 | (ml < 15 ? ml : 15);
+  if (lit_len >= 15)
+    op = put_length (op, lit_len - 15);
+  memcpy (op, lit, lit_len);
+  op += lit_len;
+  if (match_len > 0)
+    {
+      *op++ = offset & 0xff;
+      *op++ = offset >> 8;
+      if (ml >= 15)
+        op = put_length (op, ml - 15);
+    }
+  *opp = op;
+  return true;
+}
+
+/* Compresses the N bytes at SRC into DST, which has room for
+   DST_MAX bytes.  Returns the compressed length, or 0 if it would
+   exceed DST_MAX.  N must be less than 64 kB. */
+static size_t
+lz_compress (const uint8_t *src, size_t n, uint8_t *dst, size_t dst_max) 
+{
+  const uint8_t *ip = src, *anchor = src, *end = src + n;
+  uint8_t *op = dst, *op_end = dst + dst_max;
+
+  ASSERT (n < 65536);
+
+  while (end - ip >= LZ_MIN_MATCH)
+    {
+      uint32_t seq = load32 (ip);
+      unsigned h = lz_hash (seq);
+      const uint8_t *ref = src + lz_table[h];
+      size_t len;
+
+      /* The table may hold stale positions from earlier inputs,
+         so a candidate is only trusted once compared. */
+      lz_table[h] = ip - src;
+      if (ref >= ip || load32 (ref) != seq)
+        {
+          ip++;
+          continue;
+        }
+
+      for (len = LZ_MIN_MATCH; ip + len < end && ref[len] == ip[len]; len++)
+        continue;
+      if (!put_sequence (&op, op_end, anchor, ip - anchor, ip - ref, len))
+        return 0;
+      ip += len;
+      anchor = ip;
+    }
+
+  if (!put_sequence (&op, op_end, anchor, end - anchor, 0, 0))
+    return 0;
+  return op - dst;
+}
+
+/* Reads a length extension from *IPP, which must stay below
+   IP_END, and adds it to *LEN.  Returns false if truncated. */
+static bool
+get_length (const uint8_t **ipp, const uint8_t *ip_end, size_t *len) 
+{
+  const uint8_t *ip = *ipp;
+  uint8_t b;
+
+  do
+    {
+      if (ip >= ip_end)
+        return false;
+      b = *ip++;
+      *len += b;
+    }
+  while (b == 255);
+  *ipp = ip;
+  return true;
+}
+
+/* Decompresses the N bytes at SRC into exactly DST_LEN bytes at
+   DST.  Returns false if the input is malformed. */
+static bool
+lz_decompress (const uint8_t *src, size_t n, uint8_t *dst, size_t dst_len) 
+{
+  const uint8_t *ip = src, *ip_end = src + n;
+  uint8_t *op = dst, *op_end = dst + dst_len;
+
+  while (ip < ip_end)
+    {
+      uint8_t token = *ip++;
+      size_t lit_len = token >> 4, match_len = token & 15, offset;
+      const uint8_t *ref;
+
+      if (lit_len == 15 && !get_length (&ip, ip_end, &lit_len))
+        return false;
+      if (lit_len > (size_t) (ip_end - ip) || lit_len > (size_t) (op_end - op))
+        return false;
+      memcpy (op, ip, lit_len);
+      ip += lit_len;
+      op += lit_len;
+
+      /* The final sequence has no match. */
+      if (ip == ip_end)
+        break;
+
+      if (ip_end - ip < 2)
+        return false;
+      offset = ip[0] | ip[1] << 8;
+      ip += 2;
+      if (match_len == 15 && !get_length (&ip, ip_end, &match_len))
+        return false;
+      match_len += LZ_MIN_MATCH;
+      if (offset == 0 || offset > (size_t) (op - dst)
+          || match_len > (size_t) (op_end - op))
+        return false;
+
+      /* Byte by byte, since the match may overlap its copy. */
+      for (ref = op - offset; match_len > 0; match_len--)
+        *op++ = *ref++;
+    }
+  return op == op_end;
+}
@@ -0,0 +1,18 @@
+#ifndef VM_ZSWAP_H
+#define VM_ZSWAP_H
+
+#include <stddef.h>
+
+/* Default size of the compressed swap arena. */
+#define ZSWAP_SIZE_DEFAULT (256 * 1024)
+
+/* Bytes of kernel memory set aside for compressed pages. */
+extern size_t zswap_size;
+
+void zswap_init (void);
+size_t zswap_store (const void *kpage);
+void zswap_load (size_t entry, void *kpage);
+void zswap_dup (size_t entry);
+void zswap_free (size_t entry);
+
+#endif /* vm/zswap.h */